@@ -2,30 +2,28 @@
 #include "Application.hpp"
 #include "RenderingSystem.hpp"
 #include "VertexArray.hpp"
-#include "Geometry.hpp"
+#include "MeshRegistry.hpp"
 
 class DrawCube : public Pass
 {
 private:
     VertexArray vao;
+    std::shared_ptr<const MeshRegistry::Mesh> cube; // keeps the shared mesh registered
 public:
     DrawCube()
     {
-        auto cube = basegeometries::cube();
-
-        vao.bind_buffer(0, cube.vertices);
-        vao.set_ebo(cube.indices);
+        auto &registry = MeshRegistry::get_instance();
+        cube = registry.get_or_create("basegeometries::cube", basegeometries::cube);
+        registry.bind(vao, *cube);
 
-        vao.set_program(R"(
+        vao.set_program(std::string(R"(
         #version 330 core
-        
+        )") + RenderingSystem::GLSL_CAMERA_BLOCK + R"(
         layout (location = 0) in vec3 aPos;
         
-        uniform mat4 mvp;
-        
         void main()
         {
-            gl_Position = mvp * vec4(aPos.x, aPos.y, aPos.z, 1.0);
+            gl_Position = view_projection * vec4(aPos.x, aPos.y, aPos.z, 1.0);
         }
     )",
                         R"(
@@ -40,8 +38,6 @@ public:
 
     void execute() override
     {
-        Eigen::Matrix4f mvp = get_rendering_system()->get_camera()->get_projection() * get_rendering_system()->get_camera()->get_view();
-        vao.get_shader_program()->set_uniform("mvp", mvp);
         vao.render();
     }
 };
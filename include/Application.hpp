@@ -1,7 +1,9 @@
 #pragma once
 
 #include "Window.hpp"
+#include "FrameStats.hpp"
 #include <memory>
+#include <functional>
 
 class RenderingSystem;
 
@@ -11,11 +13,39 @@ class Application {
 
     RenderingSystem* rendering_system;
 
+    void render_frame();
+
 public:
     Application();
+
+    /**
+     * @brief an application rendering into the given window, e.g. Application(Window::create_headless(1920, 1080))
+     */
+    explicit Application(std::unique_ptr<Window> window);
+
     virtual ~Application();
+
+    /**
+     * @brief renders until the window is closed.
+     * "--frames N" stops after N frames, "--benchmark N" renders N frames and prints the frame time statistics.
+     * A headless window needs one of them. Returns non-zero on a usage error.
+     */
     int run(int argc, char **argv);
 
+    /**
+     * @brief renders a fixed number of frames (or until the window is closed)
+     *
+     * @param count number of frames, negative for no limit
+     * @param on_frame called after each frame with its index, returning false stops the rendering
+     */
+    void run_frames(int count, std::function<bool(int)> on_frame = nullptr);
+
+    /**
+     * @brief renders warmup + frames frames, waiting for the gpu at the end of each one, and measures the last frames
+     * @throw std::invalid_argument if a count is negative
+     */
+    FrameStats benchmark(int frames, int warmup = 10);
+
     RenderingSystem* get_rendering_system();
 
     Window* get_window();
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "MeshRegistry.hpp"
+#include "RangeAllocator.hpp"
+#include "StreamingBuffer.hpp"
+#include "VertexArray.hpp"
+
+/**
+ * @brief draws many meshes with a few glMultiDrawElementsIndirect calls.
+ *
+ * the meshes live in one shared arena (interleaved positions and normals, uint32 indices), so a single vertex array
+ * draws all of them. each frame, the queued instances are grouped by mesh : every group becomes one
+ * DrawElementsIndirectCommand, and the per instance data is written to a shader storage buffer read at
+ * gl_BaseInstance + gl_InstanceID. the commands and the instances are written to a StreamingBuffer.
+ *
+ * requires opengl 4.6 (or GL_ARB_shader_draw_parameters) and GL_ARB_buffer_storage.
+ *
+ * <pre>
+ *  BatchRenderer batch;
+ *  auto cube = batch.add(*MeshRegistry::get_instance().get_or_create("cube", basegeometries::cube));
+ *  for (auto &position : positions)
+ *  {
+ *      batch.draw(*cube, Eigen::Affine3f(Eigen::Translation3f(position)).matrix());
+ *  }
+ *  batch.render(); // one draw call
+ * <pre>
+ */
+class BatchRenderer
+{
+public:
+    /**
+     * @brief a mesh stored in the arena, valid as long as the handle returned by add() is alive
+     */
+    struct BatchMesh
+    {
+        std::string hash;
+        uint32_t base_vertex = 0;
+        uint32_t vertex_count = 0;
+        uint32_t first_index = 0;
+        uint32_t index_count = 0;
+    };
+
+    /**
+     * @brief per instance data, std430 layout
+     */
+    struct Instance
+    {
+        Eigen::Matrix4f model;
+        Eigen::Vector4f color;
+    };
+
+    /**
+     * @brief binding point of the instance storage buffer
+     */
+    static constexpr uint32_t INSTANCE_BINDING = 0;
+
+    /**
+     * @brief glsl declaration of the instance buffer, to be inserted after the #version directive of custom vertex shaders.
+     * it declares instances[] and get_instance(), the Instance of the current vertex.
+     */
+    static const char *GLSL_INSTANCE_BLOCK;
+
+private:
+    struct Entry
+    {
+        std::weak_ptr<const BatchMesh> mesh;
+        BatchMesh allocation;
+    };
+
+    struct Draw
+    {
+        uint32_t first_index;
+        uint32_t index_count;
+        uint32_t base_vertex;
+        Instance instance;
+    };
+
+    VertexArray vao;
+    std::shared_ptr<VertexBuffer> vertices;
+    std::shared_ptr<VertexBuffer> indices;
+    RangeAllocator vertex_allocator;
+    RangeAllocator index_allocator;
+    std::map<std::string, Entry> entries; // by mesh hash
+    StreamingBuffer stream;
+    size_t storage_alignment;
+    size_t max_instances;
+    std::vector<Draw> queued;
+    size_t last_draw_count = 0;
+    size_t last_command_count = 0;
+
+    static std::shared_ptr<VertexBuffer> grow(const std::shared_ptr<VertexBuffer> &buffer, size_t size);
+
+    void reserve(size_t vertex_count, size_t index_count);
+
+    void bind_arena();
+
+public:
+    /**
+     * @param vertex_capacity initial number of vertices in the arena, it grows as needed
+     * @param index_capacity initial number of indices in the arena, it grows as needed
+     * @param max_instances most instances drawn in a frame
+     */
+    BatchRenderer(size_t vertex_capacity = 1 << 16, size_t index_capacity = 3 << 16, size_t max_instances = 1 << 16);
+
+    BatchRenderer(const BatchRenderer &) = delete;
+    BatchRenderer &operator=(const BatchRenderer &) = delete;
+
+    /**
+     * @brief copies the mesh in the arena, or returns the handle of the same mesh if it is still there
+     * @throw std::invalid_argument if the mesh has no vertex
+     */
+    std::shared_ptr<const BatchMesh> add(const MeshRegistry::Mesh &mesh);
+
+    /**
+     * @brief gives the arena space of the meshes without handle back
+     */
+    void purge();
+
+    /**
+     * @brief replaces the default program, the vertex shader reads the instance block (see GLSL_INSTANCE_BLOCK)
+     * and the attributes position (location 0) and normal (location 1)
+     */
+    void set_program(std::shared_ptr<ShaderProgram> program);
+
+    std::shared_ptr<ShaderProgram> get_program();
+
+    /**
+     * @brief queues an instance of the mesh for the next render()
+     */
+    void draw(const BatchMesh &mesh, const Eigen::Matrix4f &model, const Eigen::Vector4f &color = Eigen::Vector4f::Ones());
+
+    /**
+     * @brief draws the queued instances, one multi draw call for all of them
+     * @throw std::runtime_error if more than max_instances are queued, the queue is dropped
+     */
+    void render();
+
+    /**
+     * @brief instances drawn by the last render()
+     */
+    size_t get_last_draw_count() const;
+
+    /**
+     * @brief indirect commands (distinct meshes) of the last render()
+     */
+    size_t get_last_command_count() const;
+
+    /**
+     * @brief number of meshes in the arena (alive or not, until purge() is called)
+     */
+    size_t get_mesh_count() const;
+};
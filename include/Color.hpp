@@ -1,7 +1,14 @@
 #pragma once
 
+#include <span>
+#include <string>
+#include <cstdint>
+#include <optional>
+#include <string_view>
 #include <Eigen/Dense>
 
+#include "ColorNames.hpp"
+
 class Color {
 public:
     static Eigen::Vector4f hsl_to_rgb(const Eigen::Vector3f &hsl);
@@ -11,5 +18,55 @@ public:
     static uint32_t floats_to_rgba32(const Eigen::Vector4f &);
     static uint32_t floats_to_rgba32(float r, float g, float b, float a=1.0f);
     static uint32_t floats_to_rgb24(float r, float g, float b);
+    /**
+     * @brief parses a color : a X11 name, #rrggbb[aa], rgb(r, g, b) or hsl(h[deg], s%, l%)
+     * throws std::runtime_error if the color is not recognized
+     */
     static Eigen::Vector4f for_name(const std::string &name); 
+
+    /**
+     * @brief compile time lookup of a X11 color name, as packed rgba (see rgba32_to_floats)
+     *
+     * <pre>
+     *  constexpr uint32_t background = *Color::rgba32_for_name("cornflowerblue");
+     * <pre>
+     */
+    static constexpr std::optional<uint32_t> rgba32_for_name(std::string_view name) {
+        const colornames::Entry *entry = colornames::find(name);
+        if (entry == nullptr) {
+            return std::nullopt;
+        }
+        return (uint32_t(entry->r) << 24) | (uint32_t(entry->g) << 16) | (uint32_t(entry->b) << 8) | 0xFFu;
+    }
+
+    /**
+     * batch conversions, for whole buffers (typically the pixels of a 4 channels Image).
+     * the loops are branchless so that they can be vectorized, and large buffers are split across threads (OpenMP).
+     * input and output spans must have the same number of colors.
+     */
+
+    /** packed rgba bytes (4 per color) to floats in [0, 1], optionally decoding srgb colors to linear (alpha stays linear) */
+    static void rgba8_to_floats(std::span<const uint8_t> rgba8, std::span<Eigen::Vector4f> colors, bool srgb = false);
+
+    /** floats in [0, 1] to packed rgba bytes, rounded and clamped, optionally encoding linear colors to srgb */
+    static void floats_to_rgba8(std::span<const Eigen::Vector4f> colors, std::span<uint8_t> rgba8, bool srgb = false);
+
+    /** in place srgb to linear conversion of the rgb components */
+    static void srgb_to_linear(std::span<Eigen::Vector4f> colors);
+
+    /** in place linear to srgb conversion of the rgb components */
+    static void linear_to_srgb(std::span<Eigen::Vector4f> colors);
+
+    /** same conventions as hsl_to_rgb : hue in degrees, saturation and lightness in [0, 1] */
+    static void hsl_to_rgb(std::span<const Eigen::Vector3f> hsl, std::span<Eigen::Vector4f> rgb);
+
+    static void rgb_to_hsl(std::span<const Eigen::Vector4f> rgb, std::span<Eigen::Vector3f> hsl);
+
+    /** multiplies the rgb components by alpha, in place */
+    static void premultiply_alpha(std::span<Eigen::Vector4f> colors);
+    static void premultiply_alpha(std::span<uint8_t> rgba8);
+
+    /** divides the rgb components by alpha, in place (fully transparent colors become black) */
+    static void unpremultiply_alpha(std::span<Eigen::Vector4f> colors);
+    static void unpremultiply_alpha(std::span<uint8_t> rgba8);
 };
\ No newline at end of file
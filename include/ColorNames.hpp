@@ -0,0 +1,270 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @brief the X11 color names, resolved with a perfect hash computed at compile time.
+ *
+ * names are matched ignoring case and spaces ("Light Sky Blue" is "lightskyblue"), the lookup hashes the name once,
+ * compares it with a single candidate and never allocates.
+ */
+namespace colornames
+{
+    struct Entry
+    {
+        std::string_view name;
+        uint8_t r, g, b;
+    };
+
+    inline constexpr Entry entries[] = {
+    {"snow", 255, 250, 250},
+    {"ghostwhite", 248, 248, 255},
+    {"whitesmoke", 245, 245, 245},
+    {"gainsboro", 220, 220, 220},
+    {"floralwhite", 255, 250, 240},
+    {"oldlace", 253, 245, 230},
+    {"linen", 250, 240, 230},
+    {"antiquewhite", 250, 235, 215},
+    {"papayawhip", 255, 239, 213},
+    {"blanchedalmond", 255, 235, 205},
+    {"bisque", 255, 228, 196},
+    {"peachpuff", 255, 218, 185},
+    {"navajowhite", 255, 222, 173},
+    {"moccasin", 255, 228, 181},
+    {"cornsilk", 255, 248, 220},
+    {"ivory", 255, 255, 240},
+    {"lemonchiffon", 255, 250, 205},
+    {"seashell", 255, 245, 238},
+    {"honeydew", 240, 255, 240},
+    {"mintcream", 245, 255, 250},
+    {"azure", 240, 255, 255},
+    {"aliceblue", 240, 248, 255},
+    {"lavender", 230, 230, 250},
+    {"lavenderblush", 255, 240, 245},
+    {"mistyrose", 255, 228, 225},
+    {"white", 255, 255, 255},
+    {"black", 0, 0, 0},
+    {"darkslategray", 47, 79, 79},
+    {"darkslategrey", 47, 79, 79},
+    {"dimgray", 105, 105, 105},
+    {"dimgrey", 105, 105, 105},
+    {"slategray", 112, 128, 144},
+    {"slategrey", 112, 128, 144},
+    {"lightslategray", 119, 136, 153},
+    {"lightslategrey", 119, 136, 153},
+    {"gray", 190, 190, 190},
+    {"grey", 190, 190, 190},
+    {"lightgrey", 211, 211, 211},
+    {"lightgray", 211, 211, 211},
+    {"midnightblue", 25, 25, 112},
+    {"navy", 0, 0, 128},
+    {"navyblue", 0, 0, 128},
+    {"cornflowerblue", 100, 149, 237},
+    {"darkslateblue", 72, 61, 139},
+    {"slateblue", 106, 90, 205},
+    {"mediumslateblue", 123, 104, 238},
+    {"lightslateblue", 132, 112, 255},
+    {"mediumblue", 0, 0, 205},
+    {"royalblue", 65, 105, 225},
+    {"blue", 0, 0, 255},
+    {"dodgerblue", 30, 144, 255},
+    {"deepskyblue", 0, 191, 255},
+    {"skyblue", 135, 206, 235},
+    {"lightskyblue", 135, 206, 250},
+    {"steelblue", 70, 130, 180},
+    {"lightsteelblue", 176, 196, 222},
+    {"lightblue", 173, 216, 230},
+    {"powderblue", 176, 224, 230},
+    {"paleturquoise", 175, 238, 238},
+    {"darkturquoise", 0, 206, 209},
+    {"mediumturquoise", 72, 209, 204},
+    {"turquoise", 64, 224, 208},
+    {"cyan", 0, 255, 255},
+    {"lightcyan", 224, 255, 255},
+    {"cadetblue", 95, 158, 160},
+    {"mediumaquamarine", 102, 205, 170},
+    {"aquamarine", 127, 255, 212},
+    {"darkgreen", 0, 100, 0},
+    {"darkolivegreen", 85, 107, 47},
+    {"darkseagreen", 143, 188, 143},
+    {"seagreen", 46, 139, 87},
+    {"mediumseagreen", 60, 179, 113},
+    {"lightseagreen", 32, 178, 170},
+    {"palegreen", 152, 251, 152},
+    {"springgreen", 0, 255, 127},
+    {"lawngreen", 124, 252, 0},
+    {"green", 0, 255, 0},
+    {"chartreuse", 127, 255, 0},
+    {"mediumspringgreen", 0, 250, 154},
+    {"greenyellow", 173, 255, 47},
+    {"limegreen", 50, 205, 50},
+    {"yellowgreen", 154, 205, 50},
+    {"forestgreen", 34, 139, 34},
+    {"olivedrab", 107, 142, 35},
+    {"darkkhaki", 189, 183, 107},
+    {"khaki", 240, 230, 140},
+    {"palegoldenrod", 238, 232, 170},
+    {"lightgoldenrodyellow", 250, 250, 210},
+    {"lightyellow", 255, 255, 224},
+    {"yellow", 255, 255, 0},
+    {"gold", 255, 215, 0},
+    {"lightgoldenrod", 238, 221, 130},
+    {"goldenrod", 218, 165, 32},
+    {"darkgoldenrod", 184, 134, 11},
+    {"rosybrown", 188, 143, 143},
+    {"indianred", 205, 92, 92},
+    {"saddlebrown", 139, 69, 19},
+    {"sienna", 160, 82, 45},
+    {"peru", 205, 133, 63},
+    {"burlywood", 222, 184, 135},
+    {"beige", 245, 245, 220},
+    {"wheat", 245, 222, 179},
+    {"sandybrown", 244, 164, 96},
+    {"tan", 210, 180, 140},
+    {"chocolate", 210, 105, 30},
+    {"firebrick", 178, 34, 34},
+    {"brown", 165, 42, 42},
+    {"darksalmon", 233, 150, 122},
+    {"salmon", 250, 128, 114},
+    {"lightsalmon", 255, 160, 122},
+    {"orange", 255, 165, 0},
+    {"darkorange", 255, 140, 0},
+    {"coral", 255, 127, 80},
+    {"lightcoral", 240, 128, 128},
+    {"tomato", 255, 99, 71},
+    {"orangered", 255, 69, 0},
+    {"red", 255, 0, 0},
+    {"hotpink", 255, 105, 180},
+    {"deeppink", 255, 20, 147},
+    {"pink", 255, 192, 203},
+    {"lightpink", 255, 182, 193},
+    {"palevioletred", 219, 112, 147},
+    {"maroon", 176, 48, 96},
+    {"mediumvioletred", 199, 21, 133},
+    {"violetred", 208, 32, 144},
+    {"magenta", 255, 0, 255},
+    {"violet", 238, 130, 238},
+    {"plum", 221, 160, 221},
+    {"orchid", 218, 112, 214},
+    {"mediumorchid", 186, 85, 211},
+    {"darkorchid", 153, 50, 204},
+    {"darkviolet", 148, 0, 211},
+    {"blueviolet", 138, 43, 226},
+    {"purple", 160, 32, 240},
+    {"mediumpurple", 147, 112, 219},
+    {"thistle", 216, 191, 216},
+    {"debianred", 215, 7, 81},
+    {"darkgrey", 169, 169, 169},
+    {"darkgray", 169, 169, 169},
+    {"darkblue", 0, 0, 139},
+    {"darkcyan", 0, 139, 139},
+    {"darkmagenta", 139, 0, 139},
+    {"darkred", 139, 0, 0},
+    {"lightgreen", 144, 238, 144},
+    };
+
+    inline constexpr size_t COUNT = sizeof(entries) / sizeof(Entry);
+
+    // sparse enough for a collision free seed to be found after a few attempts
+    inline constexpr size_t TABLE_SIZE = 4096;
+
+    static_assert(COUNT < 255, "slots are stored on 8 bits");
+
+    constexpr char fold(char c)
+    {
+        return c >= 'A' && c <= 'Z' ? char(c - 'A' + 'a') : c;
+    }
+
+    /**
+     * @brief FNV-1a over the lowercase characters, spaces excluded
+     */
+    constexpr uint32_t hash(std::string_view name, uint32_t seed)
+    {
+        uint32_t h = 2166136261u ^ seed;
+        for (char c : name)
+        {
+            if (c != ' ')
+            {
+                h = (h ^ uint8_t(fold(c))) * 16777619u;
+            }
+        }
+        h ^= h >> 15;
+        h *= 0x2c1b3c6du;
+        h ^= h >> 12;
+        return h;
+    }
+
+    constexpr uint32_t find_seed()
+    {
+        for (uint32_t seed = 0;; seed++)
+        {
+            bool used[TABLE_SIZE] = {};
+            bool collision = false;
+            for (size_t i = 0; i < COUNT && !collision; i++)
+            {
+                size_t slot = hash(entries[i].name, seed) % TABLE_SIZE;
+                collision = used[slot];
+                used[slot] = true;
+            }
+            if (!collision)
+            {
+                return seed;
+            }
+        }
+    }
+
+    inline constexpr uint32_t SEED = find_seed();
+
+    struct Table
+    {
+        uint8_t slots[TABLE_SIZE] = {}; // index + 1 in entries, 0 when empty
+    };
+
+    constexpr Table build_table()
+    {
+        Table table;
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            table.slots[hash(entries[i].name, SEED) % TABLE_SIZE] = uint8_t(i + 1);
+        }
+        return table;
+    }
+
+    inline constexpr Table table = build_table();
+
+    /**
+     * @brief compares a query with a (lowercase, space free) color name
+     */
+    constexpr bool matches(std::string_view query, std::string_view name)
+    {
+        size_t j = 0;
+        for (char c : query)
+        {
+            if (c == ' ')
+            {
+                continue;
+            }
+            if (j >= name.size() || fold(c) != name[j])
+            {
+                return false;
+            }
+            j++;
+        }
+        return j == name.size();
+    }
+
+    /**
+     * @brief the entry for a color name, or nullptr
+     */
+    constexpr const Entry *find(std::string_view name)
+    {
+        uint8_t slot = table.slots[hash(name, SEED) % TABLE_SIZE];
+        if (slot == 0 || !matches(name, entries[slot - 1].name))
+        {
+            return nullptr;
+        }
+        return &entries[slot - 1];
+    }
+}
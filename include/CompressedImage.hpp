@@ -0,0 +1,83 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <Eigen/Dense>
+
+#include "Blob.hpp"
+#include "Image.hpp"
+#include "ImageView.hpp"
+
+/**
+ * @brief an image encoded with one of the BCn block compression formats, ready to be uploaded with glCompressedTexImage2D.
+ *
+ * pixels are grouped by 4x4 blocks, each block taking 8 or 16 bytes :
+ * <pre>
+ *  BC1 (DXT1)  : rgb, 8 bytes per block            => 4 bits per pixel
+ *  BC3 (DXT5)  : rgba, 16 bytes per block          => 8 bits per pixel
+ *  BC4 (RGTC1) : single channel, 8 bytes per block => 4 bits per pixel
+ *  BC5 (RGTC2) : two channels, 16 bytes per block  => 8 bits per pixel (typically normal maps)
+ * <pre>
+ * the encoder fits the endpoints of each color block on its principal axis, then refines them by least squares.
+ */
+struct CompressedImage
+{
+    enum class Format
+    {
+        BC1,
+        BC3,
+        BC4,
+        BC5
+    };
+
+    Format format = Format::BC1;
+    Eigen::Vector2i dimensions = Eigen::Vector2i::Zero();
+    std::vector<uint8_t> data; // blocks, row by row
+
+    /**
+     * @brief BC4 for 1 channel, BC5 for 2, BC1 for 3 and BC3 for 4
+     */
+    static Format get_default_format(int channels);
+
+    /**
+     * @brief compresses an image, the block rows are split across threads (OpenMP)
+     *
+     * gray (and gray + alpha) images are expanded to rgb(a) for BC1/BC3, BC4 reads the first channel and BC5 the first two.
+     */
+    static CompressedImage encode(const ConstImageView &view, Format format);
+
+    static CompressedImage encode(const ConstImageView &view);
+
+    /**
+     * @brief same as encode(), but the result is kept in a directory (using the Filesystem facilities),
+     * keyed by the image hash so that an unchanged image is never compressed twice
+     *
+     * @param image
+     * @param format
+     * @param cache_directory uri of a writable directory
+     */
+    static CompressedImage encode_cached(const Image &image, Format format, const std::string &cache_directory);
+
+    /**
+     * @brief back to plain pixels (for tests, or drivers without s3tc support)
+     */
+    Image decode() const;
+
+    /**
+     * @brief file representation, as stored in the cache
+     */
+    Blob serialize() const;
+
+    static CompressedImage deserialize(const Blob &blob);
+
+    /**
+     * @brief 8 or 16 bytes
+     */
+    size_t get_block_size() const;
+
+    /**
+     * @brief channels of the decoded image
+     */
+    int get_channels() const;
+};
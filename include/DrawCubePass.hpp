@@ -2,11 +2,13 @@
 
 #include "RenderingSystem.hpp"
 #include "VertexArray.hpp"
+#include "MeshRegistry.hpp"
 
 class DrawCubePass : public Pass
 {
     private:
     VertexArray vao;
+    std::shared_ptr<const MeshRegistry::Mesh> cube; // keeps the shared mesh registered
     std::shared_ptr<VertexBuffer> vertexBuffer;
     std::shared_ptr<VertexBuffer> elementBuffer; // TODO: may change the class name to 'Buffer' and add a 'type' field
     public:    
@@ -4,6 +4,7 @@
 #include <vector>
 #include <memory>
 #include <utility>
+#include <istream>
 #include "Blob.hpp"
 
 class FsEntry {
@@ -13,10 +14,14 @@ class FsEntry {
     virtual bool is_directory()=0;
     virtual std::vector<std::shared_ptr<FsEntry>> list()=0;
     virtual Blob read()=0;
+    /** opens the entry for sequential reading, without loading it in memory */
+    virtual std::unique_ptr<std::istream> open()=0;
     void write(const Blob& blob);
     virtual void write(const void* data, size_t size)=0;
     virtual void write(std::function<std::pair<const void*, size_t>()> provider)=0;
     virtual bool is_readonly()=0;
+    /** creates the entry as a directory, along with its missing parents */
+    virtual void create_directories()=0;
     virtual long last_modified()=0;
 };
 
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief summary of the frame times measured by Application::benchmark (all durations in milliseconds)
+ */
+struct FrameStats
+{
+    size_t frames = 0;
+    double mean = 0.0;
+    double median = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+
+    /**
+     * @brief computes the statistics of a set of frame times
+     *
+     * @param samples frame times in milliseconds, in any order
+     * @return FrameStats
+     */
+    static FrameStats from_samples(std::vector<double> samples);
+
+    /**
+     * @brief one line summary, e.g. "120 frames : mean 4.12ms, median 4.05ms, p95 4.80ms, p99 5.31ms, min 3.90ms, max 6.02ms"
+     */
+    std::string to_string() const;
+};
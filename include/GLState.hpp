@@ -0,0 +1,135 @@
+#pragma once
+
+#include <map>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+/**
+ * @brief a shadow copy of the gl bindings and fixed function state, so that redundant driver calls are skipped.
+ *
+ * Every bind / enable of the engine goes through this tracker. Code that changes the gl state directly must call invalidate()
+ * afterwards, otherwise the tracker may skip a call that was needed. Deleting an object must be reported with the forget_*()
+ * functions, as gl reverts the bindings of deleted objects to 0 and reuses their names.
+ *
+ * Must be used from the thread that owns the gl context.
+ *
+ * <pre>
+ *  auto &state = GLState::get_instance();
+ *  state.use_program(program);   // glUseProgram
+ *  state.use_program(program);   // skipped
+ *  state.new_frame();
+ *  LOG(INFO) << state.get_last_frame_counters().skipped << " calls skipped";
+ * <pre>
+ */
+class GLState
+{
+public:
+    /**
+     * @brief number of state changes sent to the driver, and of the redundant ones that were not
+     */
+    struct Counters
+    {
+        size_t issued = 0;
+        size_t skipped = 0;
+    };
+
+private:
+    static constexpr uint32_t UNKNOWN = 0xFFFFFFFF;
+
+    uint32_t program = UNKNOWN;
+    uint32_t vertex_array = UNKNOWN;
+    uint32_t active_unit = UNKNOWN;
+    std::map<uint32_t, uint32_t> buffers;                               // target -> buffer
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> indexed_buffers; // (target, index) -> buffer
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> textures;        // (unit, target) -> texture
+    std::map<uint32_t, bool> capabilities;
+    uint32_t depth_func = UNKNOWN;
+    uint32_t cull_face = UNKNOWN;
+    uint32_t blend_source = UNKNOWN;
+    uint32_t blend_destination = UNKNOWN;
+    uint32_t depth_mask = UNKNOWN;
+
+    Counters counters;
+    Counters last_frame;
+
+    // counts the call, and tells if it has to be issued
+    bool update(uint32_t &cached, uint32_t value);
+
+public:
+    static GLState &get_instance();
+
+    void use_program(uint32_t program);
+
+    void bind_vertex_array(uint32_t vertex_array);
+
+    /**
+     * @brief binds a buffer to a target (GL_ARRAY_BUFFER, GL_PIXEL_UNPACK_BUFFER ...).
+     * GL_ELEMENT_ARRAY_BUFFER is part of the vertex array state, it is only tracked until the next vertex array change.
+     */
+    void bind_buffer(uint32_t target, uint32_t buffer);
+
+    /**
+     * @brief binds a buffer to an indexed binding point (GL_UNIFORM_BUFFER, GL_SHADER_STORAGE_BUFFER ...), and to the generic target
+     */
+    void bind_buffer_base(uint32_t target, uint32_t index, uint32_t buffer);
+
+    /**
+     * @brief binds a range of a buffer to an indexed binding point, and to the generic target.
+     * ranges usually move every frame, so the call is always issued
+     */
+    void bind_buffer_range(uint32_t target, uint32_t index, uint32_t buffer, size_t offset, size_t size);
+
+    void set_active_texture(uint32_t unit);
+
+    /**
+     * @brief binds a texture to the active unit
+     */
+    void bind_texture(uint32_t target, uint32_t texture);
+
+    /**
+     * @brief binds a texture to a unit, the active unit is only changed when the binding changes
+     */
+    void bind_texture(uint32_t unit, uint32_t target, uint32_t texture);
+
+    /**
+     * @brief glEnable / glDisable
+     */
+    void set_enabled(uint32_t capability, bool enabled);
+
+    void set_depth_func(uint32_t func);
+
+    void set_depth_mask(bool enabled);
+
+    void set_cull_face(uint32_t mode);
+
+    void set_blend_func(uint32_t source, uint32_t destination);
+
+    /**
+     * @brief to be called when an object is deleted
+     */
+    void forget_program(uint32_t program);
+    void forget_vertex_array(uint32_t vertex_array);
+    void forget_buffer(uint32_t buffer);
+    void forget_texture(uint32_t texture);
+
+    /**
+     * @brief forgets everything, the next calls are all issued
+     */
+    void invalidate();
+
+    /**
+     * @brief starts counting the calls of a new frame
+     */
+    void new_frame();
+
+    /**
+     * @brief calls counted since the start of the current frame
+     */
+    Counters get_counters() const;
+
+    /**
+     * @brief calls counted during the previous frame
+     */
+    Counters get_last_frame_counters() const;
+};
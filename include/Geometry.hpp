@@ -7,14 +7,27 @@
 #include <iostream>
 #include <functional>
 #include <utility>
+#include <memory>
+#include <atomic>
 #include <Eigen/Dense>
 
 #include "Ray.hpp"
+#include "MeshAdjacency.hpp"
 
 struct Geometry {
     std::vector<Eigen::Vector3f> vertices;
     std::vector<uint32_t> indices;
     std::vector<Eigen::Vector3f> normals;
+
+    // lazily built by get_adjacency(), published with an atomic swap so that geometries never wait on each other
+    struct AdjacencyCache {
+        std::atomic<std::shared_ptr<const MeshAdjacency>> value;
+        AdjacencyCache() = default;
+        AdjacencyCache(const AdjacencyCache& other) : value(other.value.load()) {}
+        AdjacencyCache& operator=(const AdjacencyCache& other) { value.store(other.value.load()); return *this; }
+    };
+    mutable AdjacencyCache adjacency;
+
     void recompute_normals();
     void transform(const Eigen::Matrix4f& transform);
     void translate(const Eigen::Vector3f& translation);
@@ -29,6 +42,23 @@ struct Geometry {
     void for_each_triangle(std::function<bool(Eigen::Vector3f&, Eigen::Vector3f&, Eigen::Vector3f&)> callback);
     Eigen::Vector3f get_centroid() const;
 
+    /**
+     * @brief half-edge adjacency of the mesh, built on first use and cached.
+     *
+     * merge() drops the cache, and it is rebuilt whenever the vertex or index count changed. Code that rewrites the
+     * indices in place without changing their count must call invalidate_adjacency().
+     * Concurrent calls on the same geometry are safe, as long as no thread modifies it meanwhile. The returned
+     * adjacency stays valid after the geometry rebuilds or drops its cache.
+     */
+    std::shared_ptr<const MeshAdjacency> get_adjacency() const;
+
+    void invalidate_adjacency();
+
+    /**
+     * @brief md5 of the vertices, indices and normals, identical meshes have the same hash
+     */
+    std::string get_hash() const;
+
     /**
      * @brief check if a ray hits the geometry
      * 
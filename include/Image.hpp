@@ -1,10 +1,13 @@
 #pragma once
 
 #include <string>
+#include <future>
+#include <vector>
 #include <Eigen/Dense>
 #include <functional>
 
 #include "Blob.hpp"
+#include "ImageView.hpp"
 
 /**
  * @brief An image is a 2D array of pixels, in cpu memory
@@ -12,15 +15,33 @@
  */
 class Image
 {
-    uint8_t *data;
+    uint8_t *data = nullptr;
     Eigen::Vector2i dimensions;
-    int channels;
-    std::function<void(void *)> deleter;
+    int channels = 0;
+    std::function<void(void *)> deleter = [](void *) {};
     Image() = default;
 public:
-    
+
+    /**
+     * @brief speed vs. size tradeoff when saving (png compression level, jpg quality).
+     * jpg encodes at the same speed whatever the quality, so Fast is the same as Default there.
+     */
+    enum class Compression
+    {
+        Fast,
+        Default,
+        Small
+    };
+
     Image(int width, int height, int channels);
 
+    /**
+     * @brief copies the pixels of a view into a new image
+     *
+     * @param view
+     */
+    explicit Image(const ConstImageView &view);
+
     /**
      * @brief load an image from a file, using the Filesystem facilities
      *
@@ -46,12 +67,48 @@ public:
      *
      * @param other
      */
-    Image(Image &&other) = default;
+    Image(Image &&other);
+
+    Image &operator=(Image &&other);
 
     ~Image();
 
     /**
-     * @brief copies a portion of the image into a new image
+     * @brief deep copy of the pixels
+     *
+     * @return Image
+     */
+    Image copy() const;
+
+    /**
+     * @brief the whole image, without copy
+     *
+     * @return ImageView
+     */
+    ImageView view();
+
+    /**
+     * @brief the whole image, read-only
+     *
+     * @return ConstImageView
+     */
+    ConstImageView view() const;
+
+    /**
+     * @brief a portion of the image, without copy
+     *
+     * @param x
+     * @param y
+     * @param width
+     * @param height
+     * @return ImageView
+     */
+    ImageView view(int x, int y, int width, int height);
+
+    ConstImageView view(int x, int y, int width, int height) const;
+
+    /**
+     * @brief copies a portion of the image into a new image (use view() to avoid the copy)
      *
      * @param x
      * @param y
@@ -62,44 +119,85 @@ public:
     Image cropped(int x, int y, int width, int height) const;
 
     /**
-     * @brief shrinks or expands the image to the given dimensions
+     * @brief shrinks or expands the image to the given dimensions (multithreaded, see imagekernels::resample)
      *
      * @param width
      * @param height
+     * @param srgb filter the colors in linear space, for images holding srgb colors
      * @return Image
      */
-    Image resized(int width, int height) const;
+    Image resized(int width, int height, bool srgb = false) const;
 
     /**
-     * @brief flips the image vertically (implementation uses Eigen)
+     * @brief computes the mipmap levels below this image, each one from the previous one, down to 1x1
+     *
+     * @param srgb filter the colors in linear space
+     * @return std::vector<Image> levels 1, 2 ... (this image is level 0)
+     */
+    std::vector<Image> build_mip_chain(bool srgb = false) const;
+
+    /**
+     * @brief flips the image vertically, the first row becomes the last
      *
      */
     void flip_vertically();
 
     /**
-     * @brief flips the image horizontally (implementation uses Eigen)
+     * @brief flips the image horizontally, mirroring each row
      *
      */
     void flip_horizontally();
 
     /**
-     * @brief rotates the image 90 degrees clockwise (implementation uses Eigen matrix transposition)
+     * @brief rotates the image 90 degrees clockwise, width and height are swapped (see imagekernels for the details)
      *
      */
     void rotate_clockwise();
 
     /**
-     * @brief rotates the image 90 degrees counterclockwise (implementation uses Eigen)
+     * @brief rotates the image 90 degrees counterclockwise, width and height are swapped
      *
      */
     void rotate_counterclockwise();
 
     /**
-     * @brief saves the image to a file, using the Filesystem facilities
+     * @brief saves the image to a file, using the Filesystem facilities.
+     * the format is given by the extension : png, jpg/jpeg, bmp, tga or hdr
      *
      * @param filename
+     * @param compression
+     */
+    void save(const std::string &filename, Compression compression = Compression::Default) const;
+
+    /**
+     * @brief encodes the image in memory
+     *
+     * @param format png, jpg/jpeg, bmp, tga or hdr
+     * @param compression
+     * @return Blob the encoded file
+     */
+    Blob encode(const std::string &format, Compression compression = Compression::Default) const;
+
+    /**
+     * @brief saves a copy of the image from a background thread (ThreadPool::get_default()), the image can be modified or destroyed right after the call
+     *
+     * @param filename
+     * @param compression
+     * @return std::future<void> throws if encoding or writing failed
+     */
+    std::future<void> save_async(const std::string &filename, Compression compression = Compression::Default) const;
+
+    /**
+     * @brief same as above, without copying the pixels
+     */
+    static std::future<void> save_async(Image &&image, const std::string &filename, Compression compression = Compression::Default);
+
+    /**
+     * @brief md5 of the dimensions and pixels, identifies the content of the image (for caches)
+     *
+     * @return std::string
      */
-    void save(const std::string &filename) const;
+    std::string get_hash() const;
 
     /**
      * @brief number of channels in the image (1 for grayscale, 3 for RGB, 4 for RGBA)
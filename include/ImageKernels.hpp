@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+#include "ImageView.hpp"
+
+/**
+ * @brief cache friendly pixel shuffling routines (1 to 4 bytes per pixel).
+ *
+ * transpositions walk the images by 16x16 tiles so that both the reads and the writes stay in cache,
+ * full tiles of 1 and 4 bytes pixels are shuffled with SSE2 when available.
+ */
+namespace imagekernels
+{
+    /**
+     * @brief writes the transposition of 'src' into 'dst' : dst(y, x) = src(x, y)
+     *
+     * @param src
+     * @param dst must be src.height x src.width, with the same channels, and must not overlap src
+     */
+    void transpose(const ConstImageView &src, const ImageView &dst);
+
+    /**
+     * @brief transposes packed pixels without a second buffer (cycle-following for non square images).
+     * slower than transpose(), to be used when memory is scarce
+     *
+     * @param data width * height * channels bytes, rows contiguous
+     * @param width
+     * @param height
+     * @param channels
+     */
+    void transpose_in_place(uint8_t *data, int width, int height, int channels);
+
+    /**
+     * @brief mirrors each row : the first pixel becomes the last
+     */
+    void flip_horizontally(const ImageView &view);
+
+    /**
+     * @brief mirrors the order of the rows : the first row becomes the last
+     */
+    void flip_vertically(const ImageView &view);
+
+    /**
+     * @brief dst = src rotated by 90 degrees clockwise (dst must be src.height x src.width)
+     */
+    void rotate_clockwise(const ConstImageView &src, const ImageView &dst);
+
+    /**
+     * @brief dst = src rotated by 90 degrees counterclockwise (dst must be src.height x src.width)
+     */
+    void rotate_counterclockwise(const ConstImageView &src, const ImageView &dst);
+
+    /**
+     * @brief resizes 'src' into 'dst' with a separable tent filter, widened when downscaling so that every source pixel contributes.
+     * the rows are split across threads (OpenMP).
+     *
+     * @param src
+     * @param dst any dimensions, same channels as src
+     * @param srgb filter the color channels in linear space (the alpha channel is always linear)
+     */
+    void resample(const ConstImageView &src, const ImageView &dst, bool srgb = false);
+}
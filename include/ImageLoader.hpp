@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Image.hpp"
+
+/**
+ * @brief reads and decodes images on background threads, the most urgent requests first.
+ *
+ * a request is abandoned as soon as every copy of its ticket is destroyed, so images that nobody waits for anymore
+ * are never decoded.
+ *
+ * <pre>
+ *  auto ticket = ImageLoader::get_default().load("file://textures/wall.png", 10);
+ *  ...
+ *  if (ticket.is_ready()) // in the render loop, the gl upload stays on the gl thread
+ *  {
+ *      texture = std::make_shared<Texture>(ticket.get());
+ *  }
+ * <pre>
+ */
+class ImageLoader
+{
+    struct Pending
+    {
+        std::string uri;
+        std::promise<Image> promise;
+        std::future<Image> future;
+        std::function<void(const Image &)> on_loaded;
+        std::atomic<bool> cancelled = false;
+    };
+
+    struct Queued
+    {
+        int priority;
+        uint64_t sequence;
+        std::weak_ptr<Pending> pending;
+
+        bool operator<(const Queued &other) const
+        {
+            // highest priority first, then first come first served
+            return priority != other.priority ? priority < other.priority : sequence > other.sequence;
+        }
+    };
+
+    std::priority_queue<Queued> queue;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable condition;
+    uint64_t sequence = 0;
+    bool stopping = false;
+
+    void work();
+
+public:
+    /**
+     * @brief the consumer side of a request
+     */
+    class Ticket
+    {
+        friend class ImageLoader;
+        std::shared_ptr<Pending> pending;
+
+        Ticket(std::shared_ptr<Pending> pending);
+
+    public:
+        Ticket() = default;
+
+        /**
+         * @brief true when get() will not block
+         */
+        bool is_ready() const;
+
+        /**
+         * @brief waits for the image, can only be called once (for all copies of the ticket)
+         * throws if the image could not be read or decoded, or if the request was cancelled
+         */
+        Image get();
+
+        /**
+         * @brief abandons the request, unless it is already being decoded
+         */
+        void cancel();
+
+        bool is_valid() const;
+    };
+
+    /**
+     * @param workers number of decoding threads, 0 means one per hardware thread
+     */
+    ImageLoader(size_t workers = 0);
+
+    ImageLoader(const ImageLoader &) = delete;
+    ImageLoader &operator=(const ImageLoader &) = delete;
+
+    /**
+     * @brief stops the workers, the requests that were not started are cancelled
+     */
+    ~ImageLoader();
+
+    static ImageLoader &get_default();
+
+    /**
+     * @brief queues an image to be read (using the Filesystem facilities) and decoded
+     *
+     * @param uri
+     * @param priority requests with a higher priority are decoded first
+     * @param on_loaded optional, called from the decoding thread once the image is available
+     * @return Ticket the request is abandoned when the ticket and all its copies are destroyed
+     */
+    Ticket load(const std::string &uri, int priority = 0, std::function<void(const Image &)> on_loaded = nullptr);
+
+    /**
+     * @brief number of requests waiting for a worker (including the abandoned ones not yet discarded)
+     */
+    size_t get_queue_size();
+};
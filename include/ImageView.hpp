@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <Eigen/Dense>
+
+/**
+ * @brief a non-owning window over pixels stored elsewhere (an Image, a decoded file, a mapped buffer ...)
+ *
+ * rows may be padded or belong to a larger image : consecutive rows are 'stride' bytes apart.
+ * the view must not outlive the pixels it points to.
+ * ImageView writes to the pixels, ConstImageView only reads them (a const Image only hands out the latter), and an
+ * ImageView converts to a ConstImageView.
+ *
+ * <pre>
+ *  Image atlas = Image::load("atlas.png");
+ *  ImageView tile = atlas.view(32, 0, 32, 32); // no copy
+ *  Texture texture(tile);                      // uploaded straight from the atlas rows
+ * <pre>
+ */
+template <typename Byte>
+class BasicImageView
+{
+    template <typename>
+    friend class BasicImageView;
+
+    // void, or const void for a read-only view
+    using Void = std::conditional_t<std::is_const_v<Byte>, const void, void>;
+
+    Byte *data = nullptr;
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    size_t stride = 0;
+
+public:
+    BasicImageView() = default;
+
+    /**
+     * @param data first pixel of the first row
+     * @param width
+     * @param height
+     * @param channels bytes per pixel
+     * @param stride distance between two rows in bytes, 0 means the rows are contiguous
+     */
+    BasicImageView(Void *data, int width, int height, int channels, size_t stride = 0);
+
+    /**
+     * @brief a read-only view over the pixels of a writable one
+     */
+    template <typename Other>
+        requires(std::is_const_v<Byte> && std::is_same_v<const Other, Byte>)
+    BasicImageView(const BasicImageView<Other> &other)
+        : data(other.data), width(other.width), height(other.height), channels(other.channels), stride(other.stride)
+    {
+    }
+
+    /**
+     * @brief a rectangular portion of this view, sharing the same pixels
+     *
+     * throws std::out_of_range if the rectangle does not fit
+     */
+    BasicImageView sub(int x, int y, int width, int height) const;
+
+    /**
+     * @brief copies the pixels to a tightly packed buffer of get_size() bytes
+     */
+    void copy_to(void *destination) const;
+
+    Byte *get_row(int y) const
+    {
+        return data + y * stride;
+    }
+
+    Byte *get_pixel(int x, int y) const
+    {
+        return get_row(y) + x * channels;
+    }
+
+    Void *get_data() const;
+
+    int get_width() const;
+
+    int get_height() const;
+
+    Eigen::Vector2i get_dimensions() const;
+
+    int get_channels() const;
+
+    size_t get_stride() const;
+
+    /**
+     * @brief number of bytes actually used in a row (width * channels)
+     */
+    size_t get_row_size() const;
+
+    /**
+     * @brief size of the pixels in bytes, once packed
+     */
+    size_t get_size() const;
+
+    /**
+     * @brief true if there is no gap between the rows
+     */
+    bool is_contiguous() const;
+};
+
+using ImageView = BasicImageView<uint8_t>;
+using ConstImageView = BasicImageView<const uint8_t>;
+
+extern template class BasicImageView<uint8_t>;
+extern template class BasicImageView<const uint8_t>;
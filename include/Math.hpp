@@ -102,3 +102,28 @@ inline Eigen::Matrix4f look_at(const Eigen::Vector3f &eye, const Eigen::Vector3f
         {-side.dot(eye), -new_up.dot(eye), forward.dot(eye), 1}
     });
 }
+
+/**
+ * @brief octahedral encoding of a unit vector : the sphere is mapped onto an octahedron, then unfolded onto the [-1, 1] square
+ * 
+ * @param n a normalized vector
+ * @return Eigen::Vector2f in [-1, 1]^2
+ */
+inline Eigen::Vector2f octahedral_encode(const Eigen::Vector3f &n) {
+    Eigen::Vector3f p = n / (std::abs(n.x()) + std::abs(n.y()) + std::abs(n.z()));
+    if (p.z() >= 0) {
+        return p.head<2>();
+    }
+    return Eigen::Vector2f(
+        (1.0f - std::abs(p.y())) * (p.x() >= 0 ? 1.0f : -1.0f),
+        (1.0f - std::abs(p.x())) * (p.y() >= 0 ? 1.0f : -1.0f)
+    );
+}
+
+inline Eigen::Vector3f octahedral_decode(const Eigen::Vector2f &e) {
+    Eigen::Vector3f n(e.x(), e.y(), 1.0f - std::abs(e.x()) - std::abs(e.y()));
+    float t = std::max(-n.z(), 0.0f);
+    n.x() += n.x() >= 0 ? -t : t;
+    n.y() += n.y() >= 0 ? -t : t;
+    return n.normalized();
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief half-edge adjacency of an indexed triangle mesh
+ *
+ * Half-edges are implicit : the half-edge h belongs to the triangle h / 3 and goes from indices[h] to indices[next(h)],
+ * so next/prev/face are simple arithmetic and only the twins need to be stored.
+ * Vertex rings are stored in CSR form (an offsets array and a flat array of values) so iterating over them is a linear scan.
+ *
+ * Edges shared by more than two triangles, or by two triangles with inconsistent winding, are treated as boundaries.
+ */
+class MeshAdjacency
+{
+    std::vector<uint32_t> origins;             // origin vertex of each half-edge (a copy of the index buffer)
+    std::vector<uint32_t> twins;               // opposite half-edge, or INVALID on boundaries
+    std::vector<uint32_t> outgoing_offsets;    // CSR offsets into outgoing_halfedges, vertex_count + 1 entries
+    std::vector<uint32_t> outgoing_halfedges;  // half-edges grouped by origin vertex
+    std::vector<uint32_t> neighbour_offsets;   // CSR offsets into neighbour_vertices, vertex_count + 1 entries
+    std::vector<uint32_t> neighbour_vertices;  // one-ring of each vertex
+    size_t non_manifold_edges = 0;
+
+public:
+    static constexpr uint32_t INVALID = 0xFFFFFFFF;
+
+    /**
+     * @brief builds the adjacency in O(n) using a hash of the directed edges
+     *
+     * @param indices triangle list, 3 indices per triangle
+     * @param vertex_count number of vertices of the mesh
+     * @throw std::invalid_argument if the index count is not a multiple of 3
+     * @throw std::out_of_range if an index is not below vertex_count
+     */
+    MeshAdjacency(const std::vector<uint32_t> &indices, size_t vertex_count);
+
+    size_t get_vertex_count() const { return outgoing_offsets.size() - 1; }
+    size_t get_face_count() const { return origins.size() / 3; }
+    size_t get_halfedge_count() const { return origins.size(); }
+
+    /**
+     * @brief number of half-edges that could not be paired because their edge is non-manifold
+     */
+    size_t get_non_manifold_edge_count() const { return non_manifold_edges; }
+
+    static uint32_t face(uint32_t h) { return h / 3; }
+    static uint32_t next(uint32_t h) { return h % 3 == 2 ? h - 2 : h + 1; }
+    static uint32_t prev(uint32_t h) { return h % 3 == 0 ? h + 2 : h - 1; }
+
+    uint32_t from(uint32_t h) const { return origins[h]; }
+    uint32_t to(uint32_t h) const { return origins[next(h)]; }
+    uint32_t twin(uint32_t h) const { return twins[h]; }
+    bool is_boundary(uint32_t h) const { return twins[h] == INVALID; }
+
+    /**
+     * @brief true if the vertex has at least one boundary half-edge leaving or entering it
+     */
+    bool is_boundary_vertex(uint32_t v) const;
+
+    /**
+     * @brief the half-edges whose origin is the given vertex. there is exactly one per incident triangle, so face(h) enumerates the vertex faces.
+     */
+    std::span<const uint32_t> outgoing(uint32_t v) const;
+
+    /**
+     * @brief the vertices sharing an edge with the given vertex (each one listed once)
+     */
+    std::span<const uint32_t> neighbours(uint32_t v) const;
+
+    /**
+     * @brief the triangles sharing an edge with the given triangle, INVALID for boundary edges.
+     * entry k is the neighbour across the edge (indices[3f+k], indices[3f+(k+1)%3])
+     */
+    std::array<uint32_t, 3> face_neighbours(uint32_t f) const;
+
+    /**
+     * @brief all the half-edges without a twin
+     */
+    std::vector<uint32_t> boundary_halfedges() const;
+};
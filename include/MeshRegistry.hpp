@@ -0,0 +1,89 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <functional>
+
+#include "Geometry.hpp"
+#include "VertexBuffer.hpp"
+
+class VertexArray;
+
+/**
+ * @brief deduplicates identical meshes, and the gpu buffers made from them.
+ *
+ * Meshes are identified by Geometry::get_hash(). The registry only keeps weak references, so a mesh (or a buffer)
+ * is released as soon as nobody uses it anymore.
+ *
+ * Owners must keep the returned mesh, typically as a member next to their vertex array : once the last reference is
+ * dropped the next get_or_create() generates it again.
+ *
+ * <pre>
+ *  cube = MeshRegistry::get_instance().get_or_create("cube", basegeometries::cube); // generated once, while cube is held
+ *  MeshRegistry::get_instance().bind(vao, *cube); // uploaded once, whatever the number of vertex arrays
+ * <pre>
+ */
+class MeshRegistry
+{
+public:
+    /**
+     * @brief an immutable geometry, along with its hash
+     */
+    struct Mesh
+    {
+        std::string hash;
+        Geometry geometry;
+    };
+
+private:
+    struct Entry
+    {
+        std::weak_ptr<const Mesh> mesh;
+        std::weak_ptr<VertexBuffer> vertices;
+        std::weak_ptr<VertexBuffer> normals;
+        std::weak_ptr<VertexBuffer> indices;
+    };
+
+    std::map<std::string, Entry> entries;      // by hash
+    std::map<std::string, std::string> names;  // name -> hash
+    std::recursive_mutex mutex;
+
+    std::shared_ptr<VertexBuffer> get_buffer(const Mesh &mesh, std::weak_ptr<VertexBuffer> Entry::*buffer, std::function<std::shared_ptr<VertexBuffer>()> create);
+
+public:
+    static MeshRegistry &get_instance();
+
+    /**
+     * @brief returns the registered mesh with the same content, or registers this one
+     */
+    std::shared_ptr<const Mesh> add(Geometry geometry);
+
+    /**
+     * @brief returns the mesh registered under that name, calling the factory only if it is not alive anymore
+     */
+    std::shared_ptr<const Mesh> get_or_create(const std::string &name, std::function<Geometry()> factory);
+
+    /**
+     * @brief shared gpu buffers for the mesh (must be called from the thread that owns the gl context)
+     */
+    std::shared_ptr<VertexBuffer> get_vertex_buffer(const Mesh &mesh);
+    std::shared_ptr<VertexBuffer> get_normal_buffer(const Mesh &mesh);
+    std::shared_ptr<VertexBuffer> get_index_buffer(const Mesh &mesh);
+
+    /**
+     * @brief binds the shared buffers of the mesh to a vertex array, a negative location skips the attribute
+     */
+    void bind(VertexArray &vao, const Mesh &mesh, int position_location = 0, int normal_location = -1);
+
+    /**
+     * @brief forgets the meshes that are not used anymore
+     */
+    void purge();
+
+    /**
+     * @brief number of registered meshes (alive or not, until purge() is called)
+     */
+    size_t get_size();
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <functional>
+#include <Eigen/Dense>
+
+#include "Geometry.hpp"
+
+struct MeshStreamOptions
+{
+    // maximum number of triangles per batch
+    size_t batch_triangles = 65536;
+    // memory used for the vertex caches during conversions, in bytes
+    size_t cache_bytes = 64 << 20;
+};
+
+/**
+ * @brief sequential access to meshes that do not fit in memory.
+ *
+ * The binary format is a sequence of small indexed meshes (batches), each one holding at most batch_triangles triangles :
+ * <pre>
+ *  header : "ZMSH" u32 version u32 flags
+ *  batch  : u32 vertex_count u32 index_count f32[3*vertex_count] positions (f32[3*vertex_count] normals) u32[index_count] indices
+ * <pre>
+ * Batches are read one at a time through the FileSystem layer, so memory usage only depends on the batch size.
+ */
+class MeshStream
+{
+    std::string uri;
+
+public:
+    struct Stats
+    {
+        size_t batches = 0;
+        size_t vertices = 0;
+        size_t triangles = 0;
+        Eigen::AlignedBox3f bounds;
+    };
+
+    MeshStream(const std::string &uri);
+
+    /**
+     * @brief calls the callback for each batch, stops when the callback returns false
+     */
+    void for_each_batch(std::function<bool(const Geometry &)> callback) const;
+
+    /**
+     * @brief counts and bounds, in a single pass
+     */
+    Stats get_stats() const;
+
+    /**
+     * @brief writes a geometry in the binary format, split in batches
+     * @throw std::invalid_argument if options.batch_triangles is 0
+     */
+    static void write(const std::string &uri, const Geometry &geometry, const MeshStreamOptions &options = {});
+
+    /**
+     * @brief converts a wavefront obj file into the binary format, with smooth vertex normals.
+     *
+     * The obj is read three times : vertices are spilled to a temporary file, then face normals are accumulated per vertex,
+     * then the batches are written. Vertex positions and normals are accessed through page caches limited to options.cache_bytes.
+     * Only positions and faces are used (polygons are triangulated as fans, negative indices are supported).
+     * @throw std::invalid_argument if options.batch_triangles is 0
+     */
+    static void convert_obj(const std::string &obj_uri, const std::string &uri, const MeshStreamOptions &options = {});
+};
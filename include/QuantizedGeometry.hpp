@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <Eigen/Dense>
+
+#include "Geometry.hpp"
+
+/**
+ * @brief a compact, gpu ready version of a Geometry.
+ *
+ * Positions are stored as 16 bits unsigned integers relative to the bounding box of the mesh, and normals are octahedral-encoded
+ * on 2x8 or 2x16 bits signed integers. Both are interleaved in a single buffer :
+ * <pre>
+ *  8 bits normals  : u16 x, u16 y, u16 z, i8 nx, i8 ny            => 8 bytes per vertex
+ *  16 bits normals : u16 x, u16 y, u16 z, u16 padding, i16 nx, i16 ny => 12 bytes per vertex
+ * <pre>
+ * instead of 24 bytes for two Eigen::Vector3f.
+ *
+ * The attributes are normalized by opengl, so the vertex shader reads positions in [0, 1]^3 and has to apply get_dequantization_matrix()
+ * (typically premultiplied into the model matrix), and decodes normals with the GLSL_OCTAHEDRAL_DECODE function.
+ */
+struct QuantizedGeometry
+{
+    enum class NormalBits
+    {
+        None,
+        Bits8,
+        Bits16
+    };
+
+    std::vector<uint8_t> data; // interleaved vertices
+    std::vector<uint32_t> indices;
+    unsigned int stride = 0;
+    NormalBits normal_bits = NormalBits::None;
+    Eigen::AlignedBox3f bounds;
+
+    /**
+     * @brief quantizes a geometry, the normals are recomputed if missing
+     */
+    static QuantizedGeometry quantize(const Geometry &geometry, NormalBits normal_bits = NormalBits::Bits8);
+
+    /**
+     * @brief back to floats (for tests and cpu processing)
+     */
+    Geometry dequantize() const;
+
+    size_t get_vertex_count() const;
+
+    /**
+     * @brief VertexStructure format strings for the attributes (see VertexStructure::parse_format)
+     */
+    std::string get_position_format() const;
+    std::string get_normal_format() const;
+
+    /**
+     * @brief maps the normalized positions ([0, 1]^3) back to the bounding box
+     */
+    Eigen::Matrix4f get_dequantization_matrix() const;
+
+    /**
+     * @brief glsl function decoding a normal : vec3 octahedral_decode(vec2 e)
+     */
+    static const char *GLSL_OCTAHEDRAL_DECODE;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+
+/**
+ * @brief hands out ranges of an abstract arena (elements of a buffer, ...), first fit.
+ * released ranges are merged with their free neighbours.
+ *
+ * <pre>
+ *  RangeAllocator allocator(1024);
+ *  size_t offset = allocator.allocate(100); // 0
+ *  allocator.release(offset, 100);
+ * <pre>
+ */
+class RangeAllocator
+{
+    std::map<size_t, size_t> free_ranges; // offset -> size
+    size_t capacity = 0;
+
+public:
+    /**
+     * @brief returned by allocate() when no free range is large enough
+     */
+    static constexpr size_t INVALID = size_t(-1);
+
+    explicit RangeAllocator(size_t capacity = 0);
+
+    /**
+     * @brief the offset of a free range of the given size, or INVALID
+     */
+    size_t allocate(size_t size);
+
+    /**
+     * @brief gives back a range returned by allocate()
+     */
+    void release(size_t offset, size_t size);
+
+    /**
+     * @brief extends the arena, the new space is free
+     */
+    void grow(size_t capacity);
+
+    size_t get_capacity() const;
+
+    /**
+     * @brief total free size, possibly fragmented
+     */
+    size_t get_free_size() const;
+};
@@ -6,6 +6,7 @@
 
 #include "Application.hpp"
 #include "Camera.hpp"
+#include "UniformBuffer.hpp"
 
 struct Pass;
 
@@ -23,8 +24,30 @@ class RenderingSystem {
 
     std::shared_ptr<Camera> camera;
 
+    std::unique_ptr<UniformBuffer> camera_buffer;
+
+    void update_camera_block();
+
     public:
 
+    /**
+     * @brief binding point of the camera uniform block, updated once per frame before the passes are executed
+     */
+    static constexpr uint32_t CAMERA_BINDING = 0;
+
+    /**
+     * @brief glsl declaration of the camera uniform block, to be inserted after the #version directive :
+     * <pre>
+     *  layout(std140) uniform Camera {
+     *      mat4 view;
+     *      mat4 projection;
+     *      mat4 view_projection;
+     *      vec3 camera_position;
+     *  };
+     * <pre>
+     */
+    static const char *GLSL_CAMERA_BLOCK;
+
     RenderingSystem(Application* application);
 
     ~RenderingSystem();
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <functional>
+#include <Eigen/Dense>
+
+#include "Geometry.hpp"
+
+/**
+ * signed distance functions : negative inside the shape, positive outside.
+ * they are plain lambdas so they can be combined freely, ex.
+ * <pre>
+ *  auto shape = sdf::smooth_union(sdf::sphere(1.0f), sdf::translated(sdf::box({0.5f, 0.5f, 0.5f}), {1, 0, 0}), 0.2f);
+ *  Geometry geometry = sdf::mesh(shape, {-2, -2, -2}, {2, 2, 2}, 128);
+ * <pre>
+ */
+namespace sdf
+{
+    using Sdf = std::function<float(const Eigen::Vector3f &)>;
+
+    Sdf sphere(float radius = 1.0f);
+    Sdf box(const Eigen::Vector3f &half_extents);
+    Sdf torus(float major_radius, float minor_radius);
+
+    Sdf translated(Sdf a, const Eigen::Vector3f &translation);
+    Sdf unite(Sdf a, Sdf b);
+    Sdf intersect(Sdf a, Sdf b);
+    Sdf subtract(Sdf a, Sdf b);
+
+    /**
+     * @brief polynomial smooth minimum of the two distances, k is the size of the blending region
+     */
+    Sdf smooth_union(Sdf a, Sdf b, float k);
+
+    /**
+     * @brief builds a welded mesh of the zero level set of the function (surface nets).
+     *
+     * The box is divided into cubic cells, resolution being the number of cells along the longest side.
+     * The grid is processed in blocks of 32^3 cells in parallel (OpenMP), so the sdf must be safe to call from several threads.
+     * Only the sign changes are kept in memory, which makes 512^3 grids practical.
+     * Vertices shared by neighbouring blocks are looked up in the vertex table of the block that owns them, so the result needs no welding.
+     * Normals are computed from the gradient of the function.
+     * Surfaces crossing the box are left open.
+     */
+    Geometry mesh(const Sdf &sdf, const Eigen::Vector3f &min, const Eigen::Vector3f &max, int resolution = 64);
+}
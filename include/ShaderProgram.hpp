@@ -1,7 +1,12 @@
 #pragma once
 
-#include <map>
+#include <memory>
 #include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
 #include <Eigen/Dense>
 
 enum class ShaderType
@@ -14,15 +19,72 @@ enum class ShaderType
     Compute
 };
 
-class ShaderProgram
+/**
+ * @brief the name of a uniform, along with its hash. The hash of a literal is computed at compile time with the _uniform suffix :
+ * <pre>
+ *  program.set_uniform("mvp"_uniform, mvp);
+ * <pre>
+ */
+struct UniformName
 {
+    std::string_view name;
+    uint64_t hash;
 
-    uint32_t id;
+    // FNV-1a
+    static constexpr uint64_t get_hash(std::string_view name)
+    {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (char c : name)
+        {
+            hash = (hash ^ uint8_t(c)) * 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    constexpr UniformName(std::string_view name) : name(name), hash(get_hash(name)) {}
+    constexpr UniformName(const char *name) : UniformName(std::string_view(name)) {}
+    UniformName(const std::string &name) : UniformName(std::string_view(name)) {}
+};
+
+consteval UniformName operator""_uniform(const char *name, size_t length)
+{
+    return UniformName(std::string_view(name, length));
+}
 
-    std::map<std::string, int32_t> uniformLocations;
+/**
+ * @brief a resolved uniform of a program, set without any lookup.
+ *
+ * Supported types : int32_t (also for samplers and booleans), uint32_t, float, Eigen::Vector2f/3f/4f, Eigen::Matrix2f/3f/4f.
+ * A default constructed handle ignores the values. ShaderProgram::uniform() throws for a uniform optimized out by the
+ * compiler, as set_uniform() does.
+ */
+template <typename T>
+class Uniform
+{
+    uint32_t program = 0;
+    int32_t location = -1;
+    friend class ShaderProgram;
 
-    int32_t get_uniform_location(const std::string &name);
+    Uniform(uint32_t program, int32_t location) : program(program), location(location) {}
 
+public:
+    Uniform() = default;
+
+    void set(const T &value) const;
+
+    int32_t get_location() const
+    {
+        return location;
+    }
+
+    bool is_valid() const
+    {
+        return location >= 0;
+    }
+};
+
+class ShaderProgram
+{
 public:
     struct ShaderDefinition
     {
@@ -30,10 +92,102 @@ public:
         std::string code;
     };
 
+private:
+    struct UniformInfo
+    {
+        std::string name;
+        int32_t location;
+        uint32_t type; // GL_FLOAT_MAT4 ...
+    };
+
+    uint32_t id;
+
+    std::unordered_map<uint64_t, UniformInfo> uniforms; // by UniformName::hash
+
+    bool pending = false;                                         // submitted, status not checked yet
+    std::vector<std::pair<ShaderType, uint32_t>> pending_shaders; // attached until the link status is checked
+    std::string cache_uri;                                        // where the binary is saved once linked
+    std::string build_error;                                      // thrown again by every use of a program that failed
+
+    ShaderProgram(const std::vector<ShaderDefinition> &shaderDefinitions, bool deferred);
+
+    // starts the compilation and the link, without waiting for them
+    void submit(const std::vector<ShaderDefinition> &shaderDefinitions, bool retrievable);
+
+    // checks the compilation and link status (waiting for them), throws on errors
+    void finish();
+
+    bool load_binary(const std::string &uri);
+
+    void save_binary(const std::string &uri);
+
+    // reads the uniforms of the linked program, and binds its uniform blocks
+    void introspect();
+
+    // throws if the uniform does not exist, or (in debug builds) if its type is not T
+    template <typename T>
+    int32_t get_uniform_location(const UniformName &name);
+
+public:
     ShaderProgram(const std::vector<ShaderDefinition> &shaderDefinitions);
     ShaderProgram(const std::string &vertex_shader, const std::string &fragment_shader);
     ~ShaderProgram();
 
+    /**
+     * @brief submits several programs to the driver before waiting for any of them, so that drivers supporting
+     * KHR_parallel_shader_compile compile them on background threads. Each program is checked on its first use,
+     * which blocks (and throws on errors) if it is not ready yet.
+     * <pre>
+     *  auto programs = ShaderProgram::build({{{ShaderType::Vertex, vs1}, {ShaderType::Fragment, fs1}},
+     *                                        {{ShaderType::Vertex, vs2}, {ShaderType::Fragment, fs2}}});
+     *  ...
+     *  if (programs[1]->is_ready()) { ... }
+     * <pre>
+     */
+    static std::vector<std::shared_ptr<ShaderProgram>> build(const std::vector<std::vector<ShaderDefinition>> &programs);
+
+    /**
+     * @brief true when the program can be used without waiting for the driver.
+     * Without KHR_parallel_shader_compile there is no way to know, and it is always true until the first use.
+     * A program whose build failed is never ready, see has_failed().
+     */
+    bool is_ready();
+
+    /**
+     * @brief true once the build is known to have failed, every use then throws get_build_error()
+     */
+    bool has_failed() const;
+
+    /**
+     * @brief the compilation or link error, empty if none is known
+     */
+    const std::string &get_build_error() const;
+
+    /**
+     * @brief waits for the compilation and link of a program returned by build(), throws on errors
+     */
+    void wait();
+
+    /**
+     * @brief caches the linked programs in a directory, so that the next runs load them without compiling any shader.
+     * The binaries are keyed by the md5 of the sources and of the driver vendor, renderer and version ; a binary rejected by the
+     * driver is compiled again from the sources. An empty directory (the default) disables the cache.
+     *
+     * @param cache_directory uri of a writable directory, e.g. "tmp://shaders", created if missing
+     * @throw std::runtime_error when the directory cannot be created
+     */
+    static void set_binary_cache(const std::string &cache_directory);
+
+    static const std::string &get_binary_cache();
+
+    /**
+     * @brief the name of the cached binary of a program
+     */
+    static std::string get_binary_key(const std::vector<ShaderDefinition> &shaderDefinitions);
+
+    /**
+     * @brief makes this program current (skipped when it already is, see GLState)
+     */
     void use();
 
     /**
@@ -42,13 +196,30 @@ public:
      */
     void run(int vertices);
 
-    void set_uniform(const std::string &name, int32_t value);
-    void set_uniform(const std::string &name, uint32_t value);
-    void set_uniform(const std::string &name, float value);
-    void set_uniform(const std::string &name, const Eigen::Vector2f &value);
-    void set_uniform(const std::string &name, const Eigen::Vector3f &value);
-    void set_uniform(const std::string &name, const Eigen::Vector4f &value);
-    void set_uniform(const std::string &name, const Eigen::Matrix2f &value);
-    void set_uniform(const std::string &name, const Eigen::Matrix3f &value);
-    void set_uniform(const std::string &name, const Eigen::Matrix4f &value);
+    /**
+     * @brief resolves a uniform once, the returned handle sets it without any lookup.
+     * Throws if the uniform does not exist, or if its glsl type does not match T (checked in debug builds, or when
+     * ZENGINE_VALIDATE_UNIFORMS is defined).
+     * <pre>
+     *  auto mvp = program.uniform<Eigen::Matrix4f>("mvp");
+     *  ...
+     *  mvp.set(projection * view * model); // every frame
+     * <pre>
+     */
+    template <typename T>
+    Uniform<T> uniform(const UniformName &name);
+
+    /**
+     * @brief sets a uniform of this program, which does not need to be in use.
+     * the uniform is looked up by the hash of its name, prefer uniform() for the uniforms set often.
+     */
+    void set_uniform(const UniformName &name, int32_t value);
+    void set_uniform(const UniformName &name, uint32_t value);
+    void set_uniform(const UniformName &name, float value);
+    void set_uniform(const UniformName &name, const Eigen::Vector2f &value);
+    void set_uniform(const UniformName &name, const Eigen::Vector3f &value);
+    void set_uniform(const UniformName &name, const Eigen::Vector4f &value);
+    void set_uniform(const UniformName &name, const Eigen::Matrix2f &value);
+    void set_uniform(const UniformName &name, const Eigen::Matrix3f &value);
+    void set_uniform(const UniformName &name, const Eigen::Matrix4f &value);
 };
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "VertexBuffer.hpp"
+
+/**
+ * @brief the offsets of a StreamingBuffer : segments used in turn, each one filled linearly during a frame
+ */
+class StreamingRing
+{
+    size_t segment_size;
+    int segment_count;
+    int current = 0;
+    size_t cursor = 0; // next free byte in the current segment
+
+public:
+    /**
+     * @throw std::invalid_argument if there is no segment
+     */
+    StreamingRing(size_t segment_size, int segment_count);
+
+    /**
+     * @brief reserves size bytes in the current segment, aligned from the start of the whole buffer
+     * @return the offset of the reserved bytes in the buffer
+     * @throw std::runtime_error when the segment is full
+     * @throw std::invalid_argument if the alignment is 0
+     */
+    size_t allocate(size_t size, size_t alignment);
+
+    /**
+     * @brief moves to the next segment, unless nothing was allocated in the current one
+     * @return true if the current segment changed
+     */
+    bool next_segment();
+
+    int get_current() const;
+
+    int get_segment_count() const;
+
+    size_t get_segment_size() const;
+
+    /**
+     * @brief bytes allocated in the current segment, padding included
+     */
+    size_t get_used_size() const;
+};
+
+/**
+ * @brief a persistently mapped vertex buffer for data rewritten every frame.
+ *
+ * the buffer is split in segments used in turn, one per frame. writes are plain memcpys into the mapped memory,
+ * and a fence per segment tells when the gpu is done reading it : next_frame() only waits when the gpu is more
+ * than segment_count - 1 frames behind. the returned ranges are bound with VertexArray::bind_buffer.
+ *
+ * requires GL_ARB_buffer_storage (core since opengl 4.4).
+ *
+ * <pre>
+ *  StreamingBuffer stream(size_t(1) << 20);
+ *  while (running)
+ *  {
+ *      stream.next_frame();
+ *      vao.bind_buffer(0, "v3", stream.write(particles));
+ *      vao.render();
+ *  }
+ * <pre>
+ */
+class StreamingBuffer
+{
+    struct Segment
+    {
+        void *fence = nullptr; // GLsync, set when the segment has been used by a frame
+    };
+
+    std::shared_ptr<VertexBuffer> buffer;
+    uint8_t *mapped = nullptr;
+    StreamingRing ring;
+    std::vector<Segment> segments;
+    int stall_count = 0;
+
+public:
+    /**
+     * @param segment_size bytes per segment, the most that can be written in a frame
+     * @param segment_count number of segments in the ring, 3 lets the cpu run two frames ahead of the gpu
+     */
+    StreamingBuffer(size_t segment_size, int segment_count = 3);
+
+    StreamingBuffer(const StreamingBuffer &) = delete;
+    StreamingBuffer &operator=(const StreamingBuffer &) = delete;
+
+    ~StreamingBuffer();
+
+    /**
+     * @brief reserves size bytes in the segment of the current frame, the caller writes to range.data
+     * @throw std::runtime_error when the segment is full
+     */
+    VertexBufferRange allocate(size_t size, size_t alignment = 16);
+
+    /**
+     * @brief copies data in the segment of the current frame
+     */
+    VertexBufferRange write(const void *data, size_t size);
+
+    template <typename T>
+    VertexBufferRange write(const std::vector<T> &vec)
+    {
+        return write(vec.data(), vec.size() * sizeof(T));
+    }
+
+    /**
+     * @brief closes the segment of the previous frame and moves to the next one, waiting for the gpu if it still reads it.
+     * Called once per frame, before the first write.
+     */
+    void next_frame();
+
+    size_t get_segment_size() const;
+
+    /**
+     * @brief bytes written in the current frame
+     */
+    size_t get_used_size() const;
+
+    /**
+     * @brief number of times next_frame() had to wait for the gpu
+     */
+    int get_stall_count() const;
+
+    std::shared_ptr<VertexBuffer> get_buffer() const;
+};
@@ -4,9 +4,11 @@
 #include <string>
 #include <functional>
 #include <memory>
+#include <vector>
 #include <Eigen/Dense>
 
 #include "Image.hpp"
+#include "CompressedImage.hpp"
 
 /**
  * @brief A texture is a 2D image that can be used in a shader
@@ -24,6 +26,9 @@ class Texture {
     // the dimensions of the texture
     Eigen::Vector2i dimensions;
 
+    // estimated video memory used by all the levels, in bytes
+    size_t memory_size = 0;
+
     public:
 
     /** read an image, and create a texture from its data */
@@ -32,6 +37,53 @@ class Texture {
     /** create a texture from an image */
     Texture(const Image &image);
 
+    /** create a texture from a portion of an image, the rows are read in place */
+    Texture(const ConstImageView &view);
+
+    /**
+     * @brief create a texture from an image and its precomputed mipmaps (see Image::build_mip_chain), instead of letting the driver generate them
+     *
+     * @param view level 0
+     * @param mip_chain levels 1, 2 ...
+     */
+    Texture(const ConstImageView &view, const std::vector<Image> &mip_chain);
+
+    /**
+     * @brief create a texture from block compressed data, the mipmaps cannot be generated by the driver so they have to be given
+     *
+     * @param image level 0
+     * @param mip_chain levels 1, 2 ... if empty, the texture is not mipmapped
+     */
+    Texture(const CompressedImage &image, const std::vector<CompressedImage> &mip_chain = {});
+
+    /**
+     * @brief allocates a texture without content, to be filled later (see TextureStreamer). it is not mipmapped until generate_mipmaps() is called
+     *
+     * @param dimensions
+     * @param channels
+     */
+    Texture(const Eigen::Vector2i &dimensions, int channels);
+
+    /**
+     * @brief uploads the pixels of a view to a level of the texture bound to 'target'.
+     * strided views are uploaded without intermediate copy, using GL_UNPACK_ROW_LENGTH.
+     *
+     * @param target GL_TEXTURE_2D, a cubemap face ...
+     * @param view
+     * @param level mipmap level
+     */
+    static void upload(uint32_t target, const ConstImageView &view, int level = 0);
+
+    /**
+     * @brief the opengl pixel format for a number of channels (GL_RED, GL_RG, GL_RGB or GL_RGBA)
+     */
+    static uint32_t get_pixel_format(int channels);
+
+    /**
+     * @brief computes the mipmaps from the level 0, and enables trilinear filtering
+     */
+    void generate_mipmaps();
+
     /**
      * @brief bind the texture to a texture unit
      * 
@@ -46,8 +98,22 @@ class Texture {
      */
     Eigen::Vector2i get_dimensions() const;
 
+    int get_channels() const;
+
+    /**
+     * @brief the opengl texture name
+     */
+    uint32_t get_id() const;
+
+    /**
+     * @brief estimation of the video memory used by the texture, mipmaps included
+     *
+     * @return size_t bytes
+     */
+    size_t get_memory_size() const;
+
     /**
-     * @brief load back data from the gpu
+     * @brief load back data from the gpu, waiting for the pipeline to drain (see TextureReadback to avoid the stall)
      * 
      * @return Image 
      */
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "Blob.hpp"
+#include "Texture.hpp"
+
+/**
+ * @brief shares the textures loaded from the same uri (or from files with the same content), within a video memory budget.
+ *
+ * Handles are cheap to copy and stay valid when their texture is evicted : the texture is read and uploaded again by the next get().
+ * When the textures resident in the cache exceed the budget, the least recently used ones are released. A texture obtained
+ * by get() should not be kept across frames, otherwise eviction cannot free it : the next get() hands that texture out again
+ * instead of uploading a copy, but it is no longer counted in the usage.
+ *
+ * Must be used from the thread that owns the gl context, and destroyed before it. The shared instance is never destroyed :
+ * its textures must be released with clear() while the context is alive (Application does it).
+ *
+ * <pre>
+ *  auto wall = TextureCache::get_instance().get("assets://wall.jpg"); // loaded once, whatever the number of walls
+ *  ...
+ *  wall.get()->to_unit(0);
+ * <pre>
+ */
+class TextureCache
+{
+public:
+    /**
+     * @brief a texture made from the content of a file, with its estimated video memory
+     */
+    struct Upload
+    {
+        std::shared_ptr<Texture> texture;
+        size_t memory_size = 0;
+    };
+
+    /**
+     * @brief makes the texture from the content of a file, the default one decodes the image and uploads it
+     */
+    using Factory = std::function<Upload(const Blob &data)>;
+
+private:
+    // a texture, shared by every uri whose content has the same md5
+    struct Resident
+    {
+        std::string hash;
+        std::shared_ptr<Texture> texture;
+        std::weak_ptr<Texture> released; // the evicted texture, alive while a caller still holds it
+        size_t memory_size = 0;
+        bool loaded = false; // false once evicted
+        std::list<Resident *>::iterator lru;
+    };
+
+    struct Slot
+    {
+        std::string uri;
+        std::shared_ptr<Resident> resident; // last known content, may have been evicted
+    };
+
+    size_t budget;
+    Factory factory;
+    size_t usage = 0;
+    std::list<Resident *> lru; // most recently used first
+    std::map<std::string, std::shared_ptr<Slot>> slots;         // by uri
+    std::map<std::string, std::shared_ptr<Resident>> residents; // by hash
+    size_t collect_threshold = 64;                              // entries in both maps that trigger the next collect()
+
+    std::shared_ptr<Texture> acquire(Slot &slot);
+
+    void touch(Resident &resident);
+
+    void evict(Resident &resident);
+
+    // forgets the uris without handles, and the evicted contents that no uri refers to
+    void collect();
+
+public:
+    class Handle
+    {
+        friend class TextureCache;
+        TextureCache *cache = nullptr;
+        std::shared_ptr<Slot> slot;
+
+        Handle(TextureCache *cache, std::shared_ptr<Slot> slot);
+
+    public:
+        Handle() = default;
+
+        /**
+         * @brief the texture, reloaded if it was evicted
+         */
+        std::shared_ptr<Texture> get() const;
+
+        /**
+         * @brief true if get() will not have to read the file again
+         */
+        bool is_resident() const;
+
+        const std::string &get_uri() const;
+    };
+
+    /**
+     * @param budget video memory allowed for the cached textures, in bytes
+     * @param factory makes the textures, Texture uploads by default
+     */
+    TextureCache(size_t budget = size_t(512) << 20, Factory factory = nullptr);
+
+    TextureCache(const TextureCache &) = delete;
+    TextureCache &operator=(const TextureCache &) = delete;
+
+    ~TextureCache();
+
+    static TextureCache &get_instance();
+
+    /**
+     * @brief a handle on the texture stored at that uri, the file is read by the first Handle::get()
+     */
+    Handle get(const std::string &uri);
+
+    void set_budget(size_t budget);
+
+    size_t get_budget() const;
+
+    /**
+     * @brief estimated video memory used by the resident textures, evicted ones still held by a caller are not counted
+     */
+    size_t get_usage() const;
+
+    /**
+     * @brief number of textures currently uploaded
+     */
+    size_t get_resident_count() const;
+
+    /**
+     * @brief evicts the least recently used textures until the usage fits in the budget
+     */
+    void trim();
+
+    /**
+     * @brief evicts every texture, handles stay valid
+     */
+    void clear();
+};
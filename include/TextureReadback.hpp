@@ -0,0 +1,80 @@
+#pragma once
+
+#include <deque>
+#include <future>
+#include <vector>
+
+#include "Image.hpp"
+#include "Texture.hpp"
+
+/**
+ * @brief reads textures (or the framebuffer) back without stalling the pipeline.
+ *
+ * the pixels are copied by the gpu into a pixel buffer, and a fence is inserted. update() maps the buffers whose fence
+ * has signaled, typically a frame or two later, and fulfills the futures. the buffers form a ring, so capturing every
+ * frame never waits as long as the ring is deeper than the gpu latency.
+ *
+ * never wait for a future on the gl thread before calling update(), it would never be fulfilled.
+ *
+ * <pre>
+ *  TextureReadback readback;
+ *  while (running)
+ *  {
+ *      ...render
+ *      captures.push_back(readback.read_framebuffer(window_size));
+ *      readback.update();
+ *  }
+ * <pre>
+ */
+class TextureReadback
+{
+    struct Slot
+    {
+        uint32_t buffer = 0;
+        size_t capacity = 0;
+        void *fence = nullptr; // GLsync, null when the slot is free
+        Eigen::Vector2i dimensions;
+        int channels = 0;
+        bool flip = false;
+        std::promise<Image> promise;
+    };
+
+    std::vector<Slot> slots;
+    std::deque<Slot *> in_flight; // oldest first
+
+    Slot &acquire(size_t size);
+
+    void finish(Slot &slot);
+
+public:
+    /**
+     * @param ring_size number of readbacks that can be pending at the same time
+     */
+    TextureReadback(int ring_size = 3);
+
+    TextureReadback(const TextureReadback &) = delete;
+    TextureReadback &operator=(const TextureReadback &) = delete;
+
+    ~TextureReadback();
+
+    /**
+     * @brief queues a copy of the level 0 of a texture. if the ring is full, the oldest readback is completed first (which may block)
+     */
+    std::future<Image> read(const Texture &texture);
+
+    /**
+     * @brief queues a copy of the bottom left corner of the framebuffer currently bound for reading, as rgb or rgba.
+     * the image is flipped so that its first row is the top of the screen
+     */
+    std::future<Image> read_framebuffer(const Eigen::Vector2i &size, int channels = 3);
+
+    /**
+     * @brief fulfills the readbacks completed by the gpu, to be called once per frame from the gl thread
+     */
+    void update();
+
+    /**
+     * @brief number of readbacks not yet fulfilled
+     */
+    size_t get_pending_count() const;
+};
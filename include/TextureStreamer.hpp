@@ -0,0 +1,101 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "Image.hpp"
+#include "Texture.hpp"
+
+/**
+ * @brief uploads textures over several frames, through a ring of persistently mapped pixel buffers.
+ *
+ * the rows of an image are split in chunks that fit a buffer. a worker thread copies each chunk into a mapped buffer,
+ * then update() (on the gl thread) issues the glTexSubImage2D reading from that buffer, and a fence tells when
+ * the buffer can be reused. at most one chunk per buffer is sent per frame, so large textures do not stall a frame.
+ *
+ * without GL_ARB_buffer_storage, the chunks are sent straight from the image memory, still spread over frames.
+ *
+ * <pre>
+ *  TextureStreamer streamer;
+ *  auto texture = streamer.upload(Image::load("assets://huge.png")); // usable, but empty for now
+ *  while (running)
+ *  {
+ *      streamer.update(); // once per frame
+ *      ...
+ *  }
+ * <pre>
+ */
+class TextureStreamer
+{
+    struct Upload
+    {
+        std::shared_ptr<Texture> texture;
+        Image image;
+        int next_row = 0;  // first row not yet given to a buffer
+        int rows_sent = 0; // rows uploaded to the texture
+        std::function<void(std::shared_ptr<Texture>)> on_complete;
+    };
+
+    enum class SlotState
+    {
+        Free,
+        Copying, // a worker fills the buffer
+        InFlight // the gpu reads the buffer
+    };
+
+    struct Slot
+    {
+        uint32_t buffer = 0;
+        uint8_t *mapped = nullptr;
+        void *fence = nullptr; // GLsync
+        SlotState state = SlotState::Free;
+        std::future<void> copy;
+        std::shared_ptr<Upload> upload;
+        int first_row = 0;
+        int row_count = 0;
+    };
+
+    size_t slot_size;
+    std::vector<Slot> slots;
+    std::deque<std::shared_ptr<Upload>> pending;  // uploads with rows not yet given to a buffer
+    std::vector<std::shared_ptr<Upload>> running; // every upload not yet complete
+    bool persistent;
+
+    int get_rows_per_chunk(const Upload &upload) const;
+
+    void complete_if_done(const std::shared_ptr<Upload> &upload);
+
+public:
+    /**
+     * @param slot_size bytes per buffer, the most that can be sent per buffer and per frame
+     * @param slot_count number of buffers in the ring
+     */
+    TextureStreamer(size_t slot_size = size_t(4) << 20, int slot_count = 4);
+
+    TextureStreamer(const TextureStreamer &) = delete;
+    TextureStreamer &operator=(const TextureStreamer &) = delete;
+
+    ~TextureStreamer();
+
+    /**
+     * @brief allocates the texture and queues its content, the mipmaps are generated once the last row is sent
+     *
+     * @param image
+     * @param on_complete optional, called from update() when the texture is complete
+     * @return std::shared_ptr<Texture> can be used right away, the missing rows are undefined
+     */
+    std::shared_ptr<Texture> upload(Image &&image, std::function<void(std::shared_ptr<Texture>)> on_complete = nullptr);
+
+    /**
+     * @brief moves the uploads forward, to be called once per frame from the gl thread
+     */
+    void update();
+
+    /**
+     * @brief number of textures not yet complete
+     */
+    size_t get_pending_count() const;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <type_traits>
+#include <condition_variable>
+
+/**
+ * @brief a fixed set of worker threads consuming a queue of tasks
+ *
+ * <pre>
+ *  auto future = ThreadPool::get_default().submit([]() { return 42; });
+ *  int result = future.get();
+ * <pre>
+ */
+class ThreadPool
+{
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping = false;
+
+    void work();
+
+    void enqueue(std::function<void()> task);
+
+public:
+    /**
+     * @param threads number of workers, 0 means one per hardware thread
+     */
+    ThreadPool(size_t threads = 0);
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+     * @brief waits for the queued tasks to complete, then joins the workers
+     */
+    ~ThreadPool();
+
+    /**
+     * @brief a pool shared by the engine for background work (encoding, decoding ...)
+     */
+    static ThreadPool &get_default();
+
+    size_t get_thread_count() const;
+
+    /**
+     * @brief queues a task, exceptions are forwarded to the returned future
+     */
+    template <typename F>
+    auto submit(F &&f) -> std::future<std::invoke_result_t<F>>
+    {
+        using R = std::invoke_result_t<F>;
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        auto future = task->get_future();
+        enqueue([task]()
+                { (*task)(); });
+        return future;
+    }
+};
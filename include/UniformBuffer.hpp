@@ -0,0 +1,115 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <Eigen/Dense>
+
+/**
+ * @brief the std140 layout of a uniform block, computed from a format string.
+ *
+ * The format uses the type names of VertexStructure::parse_format : f (float), i (int), u (unsigned int), v2, v3, v4, m2, m3, m4,
+ * optionally followed by an array size between square brackets. Members are referred to by their index in the format.
+ * <pre>
+ *  // layout(std140) uniform Light { vec3 position; float intensity; mat4 shadow[4]; };
+ *  auto layout = Std140Layout::parse_format("v3 f m4[4]");
+ *  // offsets : 0, 12, 16 ; size : 272
+ * <pre>
+ */
+struct Std140Layout
+{
+    enum class Type
+    {
+        Float,
+        Int,
+        Uint,
+        Vec2,
+        Vec3,
+        Vec4,
+        Mat2,
+        Mat3,
+        Mat4
+    };
+
+    struct Member
+    {
+        Type type;
+        unsigned int offset = 0;
+        unsigned int count = 1;  // number of array elements
+        unsigned int stride = 0; // between array elements (or matrix columns) in bytes
+    };
+
+    std::vector<Member> members;
+    unsigned int size = 0; // of the whole block in bytes
+
+    static Std140Layout parse_format(const std::string &format);
+};
+
+/**
+ * @brief a uniform block shared by several programs, bound at a fixed binding point.
+ *
+ * The values are written in a cpu copy laid out in std140, and upload() sends the modified range once, whatever
+ * the number of programs reading the block.
+ * <pre>
+ *  UniformBuffer lights("v3 f");
+ *  lights.set(0, Eigen::Vector3f(1, 2, 3));
+ *  lights.set(1, 0.5f);
+ *  lights.upload();
+ *  lights.bind(1); // layout(std140, binding = 1) uniform Lights { vec3 position; float intensity; };
+ * <pre>
+ *
+ * Blocks registered with set_block_binding() are bound automatically by every program that declares them, so
+ * shaders do not need the binding layout qualifier (unavailable before glsl 4.20).
+ */
+class UniformBuffer
+{
+    uint32_t id;
+    Std140Layout layout;
+    std::vector<uint8_t> data;
+    size_t dirty_begin;
+    size_t dirty_end = 0;
+
+    void write(int member, int element, Std140Layout::Type type, const void *value, size_t size);
+
+public:
+    explicit UniformBuffer(const std::string &format);
+    UniformBuffer(const UniformBuffer &) = delete;
+    UniformBuffer &operator=(const UniformBuffer &) = delete;
+    ~UniformBuffer();
+
+    /**
+     * @brief sets a member (or an element of an array member), throws std::invalid_argument if the type does not match the format
+     */
+    void set(int member, float value, int element = 0);
+    void set(int member, int32_t value, int element = 0);
+    void set(int member, uint32_t value, int element = 0);
+    void set(int member, const Eigen::Vector2f &value, int element = 0);
+    void set(int member, const Eigen::Vector3f &value, int element = 0);
+    void set(int member, const Eigen::Vector4f &value, int element = 0);
+    void set(int member, const Eigen::Matrix2f &value, int element = 0);
+    void set(int member, const Eigen::Matrix3f &value, int element = 0);
+    void set(int member, const Eigen::Matrix4f &value, int element = 0);
+
+    /**
+     * @brief sends the values modified since the last upload
+     */
+    void upload();
+
+    /**
+     * @brief binds the buffer to a uniform binding point
+     */
+    void bind(uint32_t binding);
+
+    const Std140Layout &get_layout() const;
+
+    uint32_t get_id() const;
+
+    /**
+     * @brief every program linked afterwards binds the uniform block with that name (if it declares it) to the binding point
+     */
+    static void set_block_binding(const std::string &block, uint32_t binding);
+
+    static const std::map<std::string, uint32_t> &get_block_bindings();
+};
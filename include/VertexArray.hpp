@@ -1,5 +1,6 @@
 #pragma once
 
+#include <map>
 #include <string>
 #include <Eigen/Dense>
 
@@ -11,11 +12,13 @@ class VertexArray
 {
     private:
         uint32_t id;
-        uint32_t ebo_id = 0;
+        std::shared_ptr<VertexBuffer> ebo;
         std::shared_ptr<ShaderProgram> shader_program;
         std::map<int, std::shared_ptr<VertexBuffer>> buffers;
         size_t count = -1; // the number of vertices, computed from the buffers of the ebo if there is one
         bool instanced = false;
+
+        void set_attribute(int location, const VertexStructure &vs, const VertexBuffer &buffer, size_t offset, int divisor);
     public:
 
     VertexArray();
@@ -43,15 +46,32 @@ class VertexArray
      */
     void bind_buffer(int location, const std::string &format, std::shared_ptr<VertexBuffer> buffer, int divisor=0);
 
+    /**
+     * @brief set the buffer at the given location to a range of a buffer, typically allocated from a StreamingBuffer each frame.
+     * Without ebo, the number of vertices becomes the number of vertices in the range.
+     */
+    void bind_buffer(int location, const std::string &format, const VertexBufferRange &range, int divisor=0);
+
     void bind_buffer(int location, const std::string &format, const std::vector<float> &buffer);
     void bind_buffer(int location, const std::vector<Eigen::Vector3f> &buffer);
 
     void unbind_buffer(int location);
 
     void set_ebo(const std::vector<uint32_t> &indices);
+
+    /**
+     * @brief use an existing buffer of uint32_t indices, which may be shared with other vertex arrays
+     */
+    void set_ebo(std::shared_ptr<VertexBuffer> indices);
     std::shared_ptr<ShaderProgram> get_shader_program();
 
     size_t get_count() const;
 
+    /**
+     * @brief makes the program and the vertex array current, after uploading the pending edits of the buffers.
+     * For draw calls issued by the caller, render() does it itself.
+     */
+    void bind();
+
     void render(); // only triangles for now
 };
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <map>
 #include <string>
 #include <vector>
+#include <cstdint>
+#include <memory>
 #include <iostream>
 
 #include <Eigen/Dense>
@@ -13,10 +16,12 @@ struct VertexStructure
     unsigned int components_count = 0; // the number of elements in this attribute, ex. "(i) f f f[2]" -> components_count=4
     unsigned int gl_type = 0;          // the type of the attribute in opengl, ex. "m4" -> gl_type=GL_FLOAT
     unsigned int stride = 0;           // the size of the entire vertex in bytes ex. "(f3) f3 (f3)" -> stride 36
+    bool normalized = false;           // integer values are mapped to [0, 1] (unsigned) or [-1, 1] (signed) ex. "wn[3]" -> normalized=true
 
     /* a small dsl that helps defining the format of a vertex buffer.
      * the format is made of space separated attributes
-     * - the first character is the type of the attribute (f for float, i for int, u for unsigned int, b for byte, v2 for 2 floats, v3 for 3 floats, v4 for 4 floats, m2 for 2x2 matrix, m3 for 3x3 matrix, m4 for 4x4 matrix)
+     * - the first character is the type of the attribute (f for float, i for int, u for unsigned int, b for byte, c for signed byte, w for unsigned short, s for short, v2 for 2 floats, v3 for 3 floats, v4 for 4 floats, m2 for 2x2 matrix, m3 for 3x3 matrix, m4 for 4x4 matrix)
+     * - integer types may be followed by 'n', meaning that the values are normalized when read by the shader (ex. "wn" : 0..65535 -> 0.0..1.0, "sn" : -32767..32767 -> -1.0..1.0)
      * - if an attribute is followed by a number between square brackets, it means that the attribute is an array of that many elements.
      * - the format string can begin or end with attributes between parenthesis, meaning that they are part of the overall buffer but not part of the attribute (see below)
      * Examples:
@@ -33,6 +38,12 @@ struct VertexStructure
      *   2: "(v3 v3) v2" or even "(b[24]) v2" which leads to the same result
      * <pre>
      *
+     * A quantized buffer with 16 bits positions and 8 bits octahedral normals packed in 8 bytes per vertex:
+     * <pre>
+     *   0: "wn[3] (c[2])"
+     *   1: "(w[3]) cn[2]"
+     * <pre>
+     *
      * In this context a glsl declaration of the vertex shader would be:
      * <pre>
      *  layout(location = 0) in vec3 position;
@@ -51,16 +62,55 @@ namespace std
     string to_string(const VertexStructure &vs);
 }
 
+/**
+ * @brief how often the content of a buffer is expected to change, a hint given to the driver
+ */
+enum class BufferUsage
+{
+    Static,  // written once, drawn many times
+    Dynamic, // modified repeatedly, drawn many times
+    Stream   // rewritten about every time it is drawn
+};
+
+/**
+ * @brief edits waiting to be uploaded, kept as disjoint ranges of bytes.
+ * overlapping or adjacent edits are merged (the latest bytes win), so each range is one upload.
+ */
+class BufferEdits
+{
+    std::map<size_t, std::vector<uint8_t>> ranges; // offset -> bytes
+
+public:
+    void add(size_t offset, const void *data, size_t size);
+
+    const std::map<size_t, std::vector<uint8_t>> &get_ranges() const;
+
+    /**
+     * @brief number of bytes waiting to be uploaded
+     */
+    size_t get_size() const;
+
+    bool empty() const;
+
+    void clear();
+};
+
 class VertexBuffer
 {
 private:
     unsigned int id;
     bool ebo = false;
-    unsigned int size; // in bytes
+    unsigned int size = 0;     // in bytes
+    unsigned int capacity = 0; // allocated bytes, at least size
+    BufferUsage usage = BufferUsage::Static;
+    BufferEdits edits;
     friend class VertexArray;
+    friend class StreamingBuffer;
+    friend class BatchRenderer;
 
 public:
     VertexBuffer();
+    explicit VertexBuffer(BufferUsage usage);
     VertexBuffer(const void *data, unsigned int size);
     VertexBuffer(const std::vector<Eigen::Vector3f> &data);
     VertexBuffer(const std::vector<uint32_t> &data);
@@ -69,6 +119,11 @@ public:
     VertexBuffer(VertexBuffer &&buffer);
     ~VertexBuffer();
 
+    /**
+     * @brief replaces the whole content. the storage is only reallocated when it grows,
+     * static buffers are allocated to the exact size, the others keep some room to grow.
+     * pending edits are dropped.
+     */
     void set_data(const void *data, unsigned int size);
 
     template<typename T>
@@ -76,9 +131,63 @@ public:
         set_data(vec.data(), vec.size() * sizeof(T));
     }
 
+    /**
+     * @brief uploads size bytes at offset now
+     * @throw std::out_of_range when the range goes past the end of the buffer
+     */
+    void update(unsigned int offset, const void *data, unsigned int size);
+
+    template<typename T>
+    void update(unsigned int offset, const std::vector<T> &vec) {
+        update(offset, vec.data(), vec.size() * sizeof(T));
+    }
+
+    /**
+     * @brief queues size bytes at offset, uploaded by the next flush().
+     * edits of the same frame are coalesced, a VertexArray flushes its buffers before drawing.
+     * @throw std::out_of_range when the range goes past the end of the buffer
+     */
+    void edit(unsigned int offset, const void *data, unsigned int size);
+
+    template<typename T>
+    void edit(unsigned int offset, const std::vector<T> &vec) {
+        edit(offset, vec.data(), vec.size() * sizeof(T));
+    }
+
+    /**
+     * @brief uploads the queued edits, one glBufferSubData per coalesced range
+     * @return the number of bytes uploaded
+     */
+    size_t flush();
+
+    bool has_pending_edits() const;
+
+    /**
+     * @brief the hint used by the next allocation
+     */
+    void set_usage(BufferUsage usage);
+
+    BufferUsage get_usage() const;
+
     /**
      * the size of the buffer in bytes
      */
     unsigned int get_size() const;
 
+    /**
+     * the allocated size of the buffer in bytes
+     */
+    unsigned int get_capacity() const;
+
+};
+
+/**
+ * @brief a part of a vertex buffer, from offset to offset + size (in bytes)
+ */
+struct VertexBufferRange
+{
+    std::shared_ptr<VertexBuffer> buffer;
+    size_t offset = 0;
+    size_t size = 0;
+    void *data = nullptr; // mapped memory of the range, when the buffer is mapped
 };
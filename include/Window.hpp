@@ -1,15 +1,47 @@
 #pragma once
+#include <memory>
 #include <string>
 #include <Eigen/Dense>
 
 #include "signal.hpp"
 
 class Window {
-    void *handle;
+    void *handle = nullptr; // GLFWwindow, null when headless
+    struct Headless;
+    std::unique_ptr<Headless> headless;
     friend class Application;
+    Window(int width, int height);
     public:
     Window(const std::string& title="", int width=800, int height=600, bool fullscreen=false);
+
+    /**
+     * @brief an offscreen window : a gl context without display (EGL, surfaceless or pbuffer) rendering into a framebuffer object.
+     * works on machines without display nor gpu, using mesa's software renderer.
+     *
+     * @param width
+     * @param height
+     * @return std::unique_ptr<Window>
+     */
+    static std::unique_ptr<Window> create_headless(int width=800, int height=600);
+
     ~Window();
     util::signal<const Eigen::Vector2i &> resized;
     Eigen::Vector2i get_dimensions() const;
-};
\ No newline at end of file
+
+    bool is_headless() const;
+
+    /**
+     * @brief true when the user asked to close the window (never for a headless window)
+     */
+    bool should_close() const;
+
+    /**
+     * @brief shows the rendered frame and processes the events, or waits for the frame to complete when headless
+     */
+    void present();
+
+    /**
+     * @brief the framebuffer that receives the frames (0 for the default framebuffer of a visible window)
+     */
+    uint32_t get_framebuffer() const;
+};
@@ -1,5 +1,7 @@
 #include "Application.hpp"
 #include "RenderingSystem.hpp"
+#include "GLState.hpp"
+#include "TextureCache.hpp"
 #include "Logging.hpp"
 #include "BackTrace.hpp"
 
@@ -8,6 +10,12 @@
 
 #include <GLFW/glfw3.h>
 
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
 #define WINDOWS
 #endif
@@ -33,13 +41,16 @@ static void fixStdout() {
 }
 #endif
 
-Application::Application() {
+Application::Application() : Application(std::make_unique<Window>()) {
+}
+
+Application::Application(std::unique_ptr<Window> window_) {
     
     #ifdef WINDOWS
     fixStdout();
     #endif
     
-    window = new Window;
+    window = window_.release();
     rendering_system = new RenderingSystem(this);
 
     // connect window resize signal to camera aspect ratio
@@ -58,6 +69,8 @@ Application::Application() {
 
 Application::~Application() {
     //delete rendering_system;
+    // the cached textures go while the context is still alive
+    TextureCache::get_instance().clear();
     delete window;
 }
 
@@ -75,25 +88,93 @@ void Application::init() {
     rendering_system->get_camera()->set_aspect(size.x() / (float)size.y());
 }
 
+// parses the value of a frame count option, -1 if it is missing or not a positive integer
+static int parse_frame_count(int argc, char **argv, int i) {
+    if (i >= argc) {
+        return -1;
+    }
+    char *end = nullptr;
+    long value = strtol(argv[i], &end, 10);
+    if (end == argv[i] || *end != '\0' || value <= 0 || value > std::numeric_limits<int>::max()) {
+        return -1;
+    }
+    return (int)value;
+}
+
 int Application::run(int argc, char **argv) {
 
+    // parse the options
+    int frames = -1;
+    int benchmark_frames = 0;
+    for (int i = 1; i < argc; i++) {
+        bool is_frames = strcmp(argv[i], "--frames") == 0;
+        if (is_frames || strcmp(argv[i], "--benchmark") == 0) {
+            int count = parse_frame_count(argc, argv, ++i);
+            if (count < 0) {
+                LOG(ERROR) << "usage : " << argv[0] << " [--frames N | --benchmark N], N a positive number of frames";
+                return 1;
+            }
+            (is_frames ? frames : benchmark_frames) = count;
+        }
+    }
+
+    // a headless window is never closed, the rendering would not stop
+    if (window->is_headless() && frames < 0 && benchmark_frames == 0) {
+        LOG(ERROR) << "a headless run needs --frames N or --benchmark N";
+        return 1;
+    }
+
     // initialize application
     init();
 
-    // render loop
-    GLFWwindow *glfw_window = (GLFWwindow *)window->handle;
-    while (!glfwWindowShouldClose(glfw_window))
-    {
+    if (benchmark_frames > 0) {
+        LOG(INFO) << benchmark(benchmark_frames).to_string();
+        return 0;
+    }
 
-        // clear buffers
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+    // render loop
+    run_frames(frames);
+    return 0;
+}
 
-        // render
-        rendering_system->render();
+void Application::run_frames(int count, std::function<bool(int)> on_frame) {
+    for (int frame = 0; (count < 0 || frame < count) && !window->should_close(); frame++) {
+        render_frame();
+        if (on_frame && !on_frame(frame)) {
+            break;
+        }
+    }
+}
 
-        // present frame buffer
-        glfwSwapBuffers(glfw_window);
-        glfwPollEvents();
+FrameStats Application::benchmark(int frames, int warmup) {
+    if (frames < 0 || warmup < 0) {
+        throw std::invalid_argument("the benchmark frame counts must not be negative");
     }
-    return 0;
+    using clock = std::chrono::steady_clock;
+    std::vector<double> samples;
+    samples.reserve(frames);
+    run_frames(warmup);
+    glFinish();
+    for (int frame = 0; frame < frames && !window->should_close(); frame++) {
+        auto start = clock::now();
+        render_frame();
+        // measure the gpu work too, not only the submission
+        glFinish();
+        samples.push_back(std::chrono::duration<double, std::milli>(clock::now() - start).count());
+    }
+    return FrameStats::from_samples(std::move(samples));
+}
+
+void Application::render_frame() {
+    GLState::get_instance().new_frame();
+    glBindFramebuffer(GL_FRAMEBUFFER, window->get_framebuffer());
+
+    // clear buffers
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+    // render
+    rendering_system->render();
+
+    // present frame buffer
+    window->present();
 }
\ No newline at end of file
@@ -0,0 +1,277 @@
+#include "BatchRenderer.hpp"
+#include "GLState.hpp"
+#include "RenderingSystem.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+static_assert(sizeof(BatchRenderer::Instance) == 80, "Instance must match the std430 layout of the instance block");
+
+/**
+ * @brief the layout read by glMultiDrawElementsIndirect
+ */
+struct DrawElementsIndirectCommand
+{
+    uint32_t count;
+    uint32_t instance_count;
+    uint32_t first_index;
+    int32_t base_vertex;
+    uint32_t base_instance;
+};
+
+static const size_t VERTEX_STRIDE = 6 * sizeof(float); // position, normal
+
+const char *BatchRenderer::GLSL_INSTANCE_BLOCK = R"(
+struct Instance {
+    mat4 model;
+    vec4 color;
+};
+layout(std430, binding = 0) readonly buffer Instances {
+    Instance instances[];
+};
+Instance get_instance() {
+    return instances[gl_BaseInstance + gl_InstanceID];
+}
+)";
+
+// the 512 bytes of slack cover the padding of the instances (the storage alignment is at most 256) and of the commands
+BatchRenderer::BatchRenderer(size_t vertex_capacity, size_t index_capacity, size_t max_instances_)
+    : stream(max_instances_ * (sizeof(Instance) + sizeof(DrawElementsIndirectCommand)) + 512), max_instances(max_instances_)
+{
+    GLint alignment = 16;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    storage_alignment = std::max<size_t>(alignment, 16);
+
+    vao.set_program(
+        std::string(R"(
+        #version 460 core
+        )") + RenderingSystem::GLSL_CAMERA_BLOCK + GLSL_INSTANCE_BLOCK + R"(
+        layout(location = 0) in vec3 position;
+        layout(location = 1) in vec3 normal;
+        out vec3 v_normal;
+        out vec4 v_color;
+        void main() {
+            Instance instance = get_instance();
+            v_normal = mat3(instance.model) * normal;
+            v_color = instance.color;
+            gl_Position = view_projection * instance.model * vec4(position, 1.0);
+        }
+    )",
+        R"(
+        #version 460 core
+        in vec3 v_normal;
+        in vec4 v_color;
+        out vec4 fragColor;
+        void main() {
+            float light = max(dot(normalize(v_normal), normalize(vec3(0.3, 1.0, 0.5))), 0.0);
+            fragColor = vec4(v_color.rgb * (0.3 + 0.7 * light), v_color.a);
+        }
+    )");
+    reserve(vertex_capacity, index_capacity);
+}
+
+std::shared_ptr<VertexBuffer> BatchRenderer::grow(const std::shared_ptr<VertexBuffer> &buffer, size_t size)
+{
+    auto grown = std::make_shared<VertexBuffer>(BufferUsage::Dynamic);
+    grown->set_data(nullptr, size);
+    if (buffer && buffer->get_size() > 0)
+    {
+        GLState::get_instance().bind_buffer(GL_COPY_READ_BUFFER, buffer->id);
+        GLState::get_instance().bind_buffer(GL_COPY_WRITE_BUFFER, grown->id);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, buffer->get_size());
+    }
+    return grown;
+}
+
+void BatchRenderer::reserve(size_t vertex_count, size_t index_count)
+{
+    if (vertex_count > vertex_allocator.get_capacity())
+    {
+        vertex_allocator.grow(vertex_count);
+        vertices = grow(vertices, vertex_count * VERTEX_STRIDE);
+    }
+    if (index_count > index_allocator.get_capacity())
+    {
+        index_allocator.grow(index_count);
+        indices = grow(indices, index_count * sizeof(uint32_t));
+    }
+    bind_arena();
+}
+
+void BatchRenderer::bind_arena()
+{
+    VertexBufferRange range{vertices, 0, vertices->get_size()};
+    vao.bind_buffer(0, "v3 (v3)", range);
+    vao.bind_buffer(1, "(v3) v3", range);
+    vao.set_ebo(indices);
+}
+
+std::shared_ptr<const BatchRenderer::BatchMesh> BatchRenderer::add(const MeshRegistry::Mesh &mesh)
+{
+    auto it = entries.find(mesh.hash);
+    if (it != entries.end())
+    {
+        if (auto alive = it->second.mesh.lock())
+        {
+            return alive;
+        }
+        // released but not purged yet, the arena still holds the same content
+        auto handle = std::make_shared<const BatchMesh>(it->second.allocation);
+        it->second.mesh = handle;
+        return handle;
+    }
+
+    const Geometry &geometry = mesh.geometry;
+    if (geometry.vertices.empty())
+    {
+        // an empty range would share its offset with another mesh, and be drawn as that mesh
+        throw std::invalid_argument("empty meshes cannot be batched");
+    }
+    std::vector<Eigen::Vector3f> normals = geometry.normals;
+    if (normals.size() != geometry.vertices.size())
+    {
+        Geometry copy = geometry.copy();
+        copy.recompute_normals();
+        normals = copy.normals;
+    }
+    std::vector<float> interleaved;
+    interleaved.reserve(geometry.vertices.size() * 6);
+    for (size_t i = 0; i < geometry.vertices.size(); i++)
+    {
+        interleaved.insert(interleaved.end(), geometry.vertices[i].data(), geometry.vertices[i].data() + 3);
+        interleaved.insert(interleaved.end(), normals[i].data(), normals[i].data() + 3);
+    }
+    std::vector<uint32_t> mesh_indices = geometry.indices;
+    if (mesh_indices.empty())
+    {
+        mesh_indices.resize(geometry.vertices.size());
+        std::iota(mesh_indices.begin(), mesh_indices.end(), 0);
+    }
+
+    BatchMesh allocation{mesh.hash, 0, uint32_t(geometry.vertices.size()), 0, uint32_t(mesh_indices.size())};
+    size_t base_vertex = vertex_allocator.allocate(allocation.vertex_count);
+    size_t first_index = index_allocator.allocate(allocation.index_count);
+    if (base_vertex == RangeAllocator::INVALID || first_index == RangeAllocator::INVALID)
+    {
+        if (base_vertex != RangeAllocator::INVALID)
+        {
+            vertex_allocator.release(base_vertex, allocation.vertex_count);
+        }
+        if (first_index != RangeAllocator::INVALID)
+        {
+            index_allocator.release(first_index, allocation.index_count);
+        }
+        // the arena at least doubles, so growing stays amortized
+        reserve(std::max(vertex_allocator.get_capacity() * 2, vertex_allocator.get_capacity() + allocation.vertex_count),
+                std::max(index_allocator.get_capacity() * 2, index_allocator.get_capacity() + allocation.index_count));
+        base_vertex = vertex_allocator.allocate(allocation.vertex_count);
+        first_index = index_allocator.allocate(allocation.index_count);
+    }
+    allocation.base_vertex = base_vertex;
+    allocation.first_index = first_index;
+    vertices->update(base_vertex * VERTEX_STRIDE, interleaved);
+    indices->update(first_index * sizeof(uint32_t), mesh_indices);
+
+    auto handle = std::make_shared<const BatchMesh>(allocation);
+    entries[mesh.hash] = Entry{handle, allocation};
+    return handle;
+}
+
+void BatchRenderer::purge()
+{
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        if (it->second.mesh.expired())
+        {
+            const BatchMesh &allocation = it->second.allocation;
+            vertex_allocator.release(allocation.base_vertex, allocation.vertex_count);
+            index_allocator.release(allocation.first_index, allocation.index_count);
+            it = entries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void BatchRenderer::set_program(std::shared_ptr<ShaderProgram> program)
+{
+    vao.set_program(program);
+}
+
+std::shared_ptr<ShaderProgram> BatchRenderer::get_program()
+{
+    return vao.get_shader_program();
+}
+
+void BatchRenderer::draw(const BatchMesh &mesh, const Eigen::Matrix4f &model, const Eigen::Vector4f &color)
+{
+    queued.push_back(Draw{mesh.first_index, mesh.index_count, mesh.base_vertex, Instance{model, color}});
+}
+
+void BatchRenderer::render()
+{
+    last_draw_count = queued.size();
+    last_command_count = 0;
+    if (queued.empty())
+    {
+        return;
+    }
+    if (queued.size() > max_instances)
+    {
+        queued.clear();
+        throw std::runtime_error(std::to_string(last_draw_count) + " instances queued, the batch renderer draws at most " + std::to_string(max_instances) + " per frame");
+    }
+    stream.next_frame();
+
+    // the instances of a mesh are contiguous, so each mesh is a single command.
+    // the first index alone is not enough : after a purge() a new mesh may reuse the range of a mesh still queued
+    auto mesh_of = [](const Draw &draw)
+    { return std::tie(draw.first_index, draw.base_vertex, draw.index_count); };
+    std::stable_sort(queued.begin(), queued.end(), [&](const Draw &a, const Draw &b)
+                     { return mesh_of(a) < mesh_of(b); });
+
+    auto instances = stream.allocate(queued.size() * sizeof(Instance), storage_alignment);
+    Instance *mapped = static_cast<Instance *>(instances.data);
+    std::vector<DrawElementsIndirectCommand> commands;
+    for (size_t i = 0; i < queued.size(); i++)
+    {
+        const Draw &draw = queued[i];
+        mapped[i] = draw.instance;
+        if (i == 0 || mesh_of(queued[i - 1]) != mesh_of(draw))
+        {
+            commands.push_back(DrawElementsIndirectCommand{draw.index_count, 0, draw.first_index, int32_t(draw.base_vertex), uint32_t(i)});
+        }
+        commands.back().instance_count++;
+    }
+    auto command_range = stream.write(commands);
+
+    vao.bind();
+    GLState::get_instance().bind_buffer(GL_DRAW_INDIRECT_BUFFER, command_range.buffer->id);
+    GLState::get_instance().bind_buffer_range(GL_SHADER_STORAGE_BUFFER, INSTANCE_BINDING, instances.buffer->id, instances.offset, instances.size);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<void *>(command_range.offset), commands.size(), 0);
+
+    last_command_count = commands.size();
+    queued.clear();
+}
+
+size_t BatchRenderer::get_last_draw_count() const
+{
+    return last_draw_count;
+}
+
+size_t BatchRenderer::get_last_command_count() const
+{
+    return last_command_count;
+}
+
+size_t BatchRenderer::get_mesh_count() const
+{
+    return entries.size();
+}
@@ -1,6 +1,9 @@
 #include "Color.hpp"
-#include <regex>
-#include "strutil.hpp"
+#include "Srgb.hpp"
+#include <cctype>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
 
 Eigen::Vector4f Color::rgba32_to_floats(uint32_t color) {
     int r = (color >> 24) & 0xFF;
@@ -82,191 +85,244 @@ Eigen::Vector3f Color::rgb_to_hsl(const Eigen::Vector4f &rgb) {
     return Eigen::Vector3f(h * 360.0f, s, l);
 }
 
-static const std::map<std::string, Eigen::Vector3i> color_map{
-{"snow", {255, 250, 250}},
-{"ghostwhite", {248, 248, 255}},
-{"whitesmoke", {245, 245, 245}},
-{"gainsboro", {220, 220, 220}},
-{"floralwhite", {255, 250, 240}},
-{"oldlace", {253, 245, 230}},
-{"linen", {250, 240, 230}},
-{"antiquewhite", {250, 235, 215}},
-{"papayawhip", {255, 239, 213}},
-{"blanchedalmond", {255, 235, 205}},
-{"bisque", {255, 228, 196}},
-{"peachpuff", {255, 218, 185}},
-{"navajowhite", {255, 222, 173}},
-{"moccasin", {255, 228, 181}},
-{"cornsilk", {255, 248, 220}},
-{"ivory", {255, 255, 240}},
-{"lemonchiffon", {255, 250, 205}},
-{"seashell", {255, 245, 238}},
-{"honeydew", {240, 255, 240}},
-{"mintcream", {245, 255, 250}},
-{"azure", {240, 255, 255}},
-{"aliceblue", {240, 248, 255}},
-{"lavender", {230, 230, 250}},
-{"lavenderblush", {255, 240, 245}},
-{"mistyrose", {255, 228, 225}},
-{"white", {255, 255, 255}},
-{"black", {0, 0, 0}},
-{"darkslategray", {47, 79, 79}},
-{"darkslategrey", {47, 79, 79}},
-{"dimgray", {105, 105, 105}},
-{"dimgrey", {105, 105, 105}},
-{"slategray", {112, 128, 144}},
-{"slategrey", {112, 128, 144}},
-{"lightslategray", {119, 136, 153}},
-{"lightslategrey", {119, 136, 153}},
-{"gray", {190, 190, 190}},
-{"grey", {190, 190, 190}},
-{"lightgrey", {211, 211, 211}},
-{"lightgray", {211, 211, 211}},
-{"midnightblue", {25, 25, 112}},
-{"navy", {0, 0, 128}},
-{"navyblue", {0, 0, 128}},
-{"cornflowerblue", {100, 149, 237}},
-{"darkslateblue", {72, 61, 139}},
-{"slateblue", {106, 90, 205}},
-{"mediumslateblue", {123, 104, 238}},
-{"lightslateblue", {132, 112, 255}},
-{"mediumblue", {0, 0, 205}},
-{"royalblue", {65, 105, 225}},
-{"blue", {0, 0, 255}},
-{"dodgerblue", {30, 144, 255}},
-{"deepskyblue", {0, 191, 255}},
-{"skyblue", {135, 206, 235}},
-{"lightskyblue", {135, 206, 250}},
-{"steelblue", {70, 130, 180}},
-{"lightsteelblue", {176, 196, 222}},
-{"lightblue", {173, 216, 230}},
-{"powderblue", {176, 224, 230}},
-{"paleturquoise", {175, 238, 238}},
-{"darkturquoise", {0, 206, 209}},
-{"mediumturquoise", {72, 209, 204}},
-{"turquoise", {64, 224, 208}},
-{"cyan", {0, 255, 255}},
-{"lightcyan", {224, 255, 255}},
-{"cadetblue", {95, 158, 160}},
-{"mediumaquamarine", {102, 205, 170}},
-{"aquamarine", {127, 255, 212}},
-{"darkgreen", {0, 100, 0}},
-{"darkolivegreen", {85, 107, 47}},
-{"darkseagreen", {143, 188, 143}},
-{"seagreen", {46, 139, 87}},
-{"mediumseagreen", {60, 179, 113}},
-{"lightseagreen", {32, 178, 170}},
-{"palegreen", {152, 251, 152}},
-{"springgreen", {0, 255, 127}},
-{"lawngreen", {124, 252, 0}},
-{"green", {0, 255, 0}},
-{"chartreuse", {127, 255, 0}},
-{"mediumspringgreen", {0, 250, 154}},
-{"greenyellow", {173, 255, 47}},
-{"limegreen", {50, 205, 50}},
-{"yellowgreen", {154, 205, 50}},
-{"forestgreen", {34, 139, 34}},
-{"olivedrab", {107, 142, 35}},
-{"darkkhaki", {189, 183, 107}},
-{"khaki", {240, 230, 140}},
-{"palegoldenrod", {238, 232, 170}},
-{"lightgoldenrodyellow", {250, 250, 210}},
-{"lightyellow", {255, 255, 224}},
-{"yellow", {255, 255, 0}},
-{"gold", {255, 215, 0}},
-{"lightgoldenrod", {238, 221, 130}},
-{"goldenrod", {218, 165, 32}},
-{"darkgoldenrod", {184, 134, 11}},
-{"rosybrown", {188, 143, 143}},
-{"indianred", {205, 92, 92}},
-{"saddlebrown", {139, 69, 19}},
-{"sienna", {160, 82, 45}},
-{"peru", {205, 133, 63}},
-{"burlywood", {222, 184, 135}},
-{"beige", {245, 245, 220}},
-{"wheat", {245, 222, 179}},
-{"sandybrown", {244, 164, 96}},
-{"tan", {210, 180, 140}},
-{"chocolate", {210, 105, 30}},
-{"firebrick", {178, 34, 34}},
-{"brown", {165, 42, 42}},
-{"darksalmon", {233, 150, 122}},
-{"salmon", {250, 128, 114}},
-{"lightsalmon", {255, 160, 122}},
-{"orange", {255, 165, 0}},
-{"darkorange", {255, 140, 0}},
-{"coral", {255, 127, 80}},
-{"lightcoral", {240, 128, 128}},
-{"tomato", {255, 99, 71}},
-{"orangered", {255, 69, 0}},
-{"red", {255, 0, 0}},
-{"hotpink", {255, 105, 180}},
-{"deeppink", {255, 20, 147}},
-{"pink", {255, 192, 203}},
-{"lightpink", {255, 182, 193}},
-{"palevioletred", {219, 112, 147}},
-{"maroon", {176, 48, 96}},
-{"mediumvioletred", {199, 21, 133}},
-{"violetred", {208, 32, 144}},
-{"magenta", {255, 0, 255}},
-{"violet", {238, 130, 238}},
-{"plum", {221, 160, 221}},
-{"orchid", {218, 112, 214}},
-{"mediumorchid", {186, 85, 211}},
-{"darkorchid", {153, 50, 204}},
-{"darkviolet", {148, 0, 211}},
-{"blueviolet", {138, 43, 226}},
-{"purple", {160, 32, 240}},
-{"mediumpurple", {147, 112, 219}},
-{"thistle", {216, 191, 216}},
-{"debianred", {215, 7, 81}},
-{"darkgrey", {169, 169, 169}},
-{"darkgray", {169, 169, 169}},
-{"darkblue", {0, 0, 139}},
-{"darkcyan", {0, 139, 139}},
-{"darkmagenta", {139, 0, 139}},
-{"darkred", {139, 0, 0}},
-{"lightgreen", {144, 238, 144}}
-};
+// buffers larger than this are split across threads
+static const std::ptrdiff_t PARALLEL_THRESHOLD = 1 << 16;
 
-Eigen::Vector4f Color::for_name(const std::string &name) {
+static void check_sizes(size_t a, size_t b) {
+    if (a != b) {
+        throw std::invalid_argument("color buffers do not have the same size");
+    }
+}
+
+void Color::rgba8_to_floats(std::span<const uint8_t> rgba8, std::span<Eigen::Vector4f> colors, bool srgb) {
+    check_sizes(rgba8.size(), colors.size() * 4);
+    const srgb::Tables &tables = srgb::Tables::get();
+    std::ptrdiff_t n = colors.size();
+    const uint8_t *in = rgba8.data();
+    Eigen::Vector4f *out = colors.data();
+    if (srgb) {
+#pragma omp parallel for if (n > PARALLEL_THRESHOLD)
+        for (std::ptrdiff_t i = 0; i < n; i++) {
+            const uint8_t *c = in + 4 * i;
+            out[i] = Eigen::Vector4f(tables.byte_to_linear[c[0]], tables.byte_to_linear[c[1]], tables.byte_to_linear[c[2]], c[3] / 255.0f);
+        }
+    } else {
+#pragma omp parallel for if (n > PARALLEL_THRESHOLD)
+        for (std::ptrdiff_t i = 0; i < n; i++) {
+            const uint8_t *c = in + 4 * i;
+            out[i] = Eigen::Vector4f(c[0], c[1], c[2], c[3]) / 255.0f;
+        }
+    }
+}
+
+// the srgb choice is a template parameter so that the loop itself does not branch
+template <bool SRGB>
+static void floats_to_rgba8_loop(const Eigen::Vector4f *in, uint8_t *out, std::ptrdiff_t n) {
+    const srgb::Tables &tables = srgb::Tables::get();
+#pragma omp parallel for if (n > PARALLEL_THRESHOLD)
+    for (std::ptrdiff_t i = 0; i < n; i++) {
+        Eigen::Vector4f c = in[i];
+        if constexpr (SRGB) {
+            c.x() = srgb::Tables::sample(tables.to_srgb, c.x());
+            c.y() = srgb::Tables::sample(tables.to_srgb, c.y());
+            c.z() = srgb::Tables::sample(tables.to_srgb, c.z());
+        }
+        Eigen::Vector4f bytes = (c.cwiseMax(0.0f).cwiseMin(1.0f) * 255.0f).array() + 0.5f;
+        for (int k = 0; k < 4; k++) {
+            out[4 * i + k] = uint8_t(bytes[k]);
+        }
+    }
+}
 
-    static std::regex hex_color("#([0-9a-fA-F]{6})([0-9a-fA-F]{2})?");
-    static std::regex rgb_color("rgb\\((\\d+),\\s*(\\d+),\\s*(\\d+)\\)");
-    static std::regex hsl_color("hsl\\((\\d+)(deg)?,\\s*(\\d+)%,\\s*(\\d+)%\\)");
-    std::smatch match;
+void Color::floats_to_rgba8(std::span<const Eigen::Vector4f> colors, std::span<uint8_t> rgba8, bool srgb) {
+    check_sizes(rgba8.size(), colors.size() * 4);
+    if (srgb) {
+        floats_to_rgba8_loop<true>(colors.data(), rgba8.data(), colors.size());
+    } else {
+        floats_to_rgba8_loop<false>(colors.data(), rgba8.data(), colors.size());
+    }
+}
 
-    auto it = color_map.find(strutil::to_lower(strutil::remove_all(name, " ")));
-    if (it != color_map.end()) {
-        return Eigen::Vector4f(it->second[0] / 255.0f, it->second[1] / 255.0f, it->second[2] / 255.0f, 1.0f);
+void Color::srgb_to_linear(std::span<Eigen::Vector4f> colors) {
+    const srgb::Tables &tables = srgb::Tables::get();
+    std::ptrdiff_t n = colors.size();
+    Eigen::Vector4f *c = colors.data();
+#pragma omp parallel for if (n > PARALLEL_THRESHOLD)
+    for (std::ptrdiff_t i = 0; i < n; i++) {
+        for (int k = 0; k < 3; k++) {
+            c[i][k] = srgb::Tables::sample(tables.to_linear, c[i][k]);
+        }
     }
+}
 
-    else if (std::regex_match(name, match, hex_color)) {
-        std::string hex = match[1];
-        std::string alpha = match[2];
-        if (alpha.empty()) {
-            alpha = "FF";
+void Color::linear_to_srgb(std::span<Eigen::Vector4f> colors) {
+    const srgb::Tables &tables = srgb::Tables::get();
+    std::ptrdiff_t n = colors.size();
+    Eigen::Vector4f *c = colors.data();
+#pragma omp parallel for if (n > PARALLEL_THRESHOLD)
+    for (std::ptrdiff_t i = 0; i < n; i++) {
+        for (int k = 0; k < 3; k++) {
+            c[i][k] = srgb::Tables::sample(tables.to_srgb, c[i][k]);
         }
-        int r = std::stoi(hex.substr(0, 2), nullptr, 16);
-        int g = std::stoi(hex.substr(2, 2), nullptr, 16);
-        int b = std::stoi(hex.substr(4, 2), nullptr, 16);
-        int a = std::stoi(alpha, nullptr, 16);
-        return Eigen::Vector4f(r / 255.0f, g / 255.0f, b / 255.0f, a / 255.0f);
     }
+}
+
+void Color::hsl_to_rgb(std::span<const Eigen::Vector3f> hsl, std::span<Eigen::Vector4f> rgb) {
+    check_sizes(hsl.size(), rgb.size());
+    std::ptrdiff_t n = hsl.size();
+    const Eigen::Vector3f *in = hsl.data();
+    Eigen::Vector4f *out = rgb.data();
+#pragma omp parallel for if (n > PARALLEL_THRESHOLD)
+    for (std::ptrdiff_t i = 0; i < n; i++) {
+        // f(n) = l - a * max(-1, min(k - 3, 9 - k, 1)), with k = (n + h / 30) mod 12
+        float h = in[i].x() / 30.0f, s = in[i].y(), l = in[i].z();
+        float a = s * std::min(l, 1.0f - l);
+        Eigen::Vector3f k = (Eigen::Vector3f(0.0f, 8.0f, 4.0f).array() + h).matrix();
+        k = (k.array() - 12.0f * (k.array() / 12.0f).floor()).matrix();
+        Eigen::Array3f ramp = (k.array() - 3.0f).min(9.0f - k.array()).min(1.0f).max(-1.0f);
+        out[i] << (l - a * ramp).matrix(), 1.0f;
+    }
+}
+
+void Color::rgb_to_hsl(std::span<const Eigen::Vector4f> rgb, std::span<Eigen::Vector3f> hsl) {
+    check_sizes(hsl.size(), rgb.size());
+    std::ptrdiff_t n = rgb.size();
+    const Eigen::Vector4f *in = rgb.data();
+    Eigen::Vector3f *out = hsl.data();
+#pragma omp parallel for if (n > PARALLEL_THRESHOLD)
+    for (std::ptrdiff_t i = 0; i < n; i++) {
+        float r = in[i].x(), g = in[i].y(), b = in[i].z();
+        float max = std::max(r, std::max(g, b));
+        float min = std::min(r, std::min(g, b));
+        float l = (max + min) / 2.0f;
+        float d = max - min;
+        float safe_d = d > 0.0f ? d : 1.0f;
+        float sum = l > 0.5f ? 2.0f - max - min : max + min;
+        float s = d > 0.0f ? d / (sum > 0.0f ? sum : 1.0f) : 0.0f;
+        float h = max == r ? (g - b) / safe_d + (g < b ? 6.0f : 0.0f) : max == g ? (b - r) / safe_d + 2.0f : (r - g) / safe_d + 4.0f;
+        out[i] = Eigen::Vector3f(d > 0.0f ? h * 60.0f : 0.0f, s, l);
+    }
+}
+
+void Color::premultiply_alpha(std::span<Eigen::Vector4f> colors) {
+    std::ptrdiff_t n = colors.size();
+    Eigen::Vector4f *c = colors.data();
+#pragma omp parallel for if (n > PARALLEL_THRESHOLD)
+    for (std::ptrdiff_t i = 0; i < n; i++) {
+        c[i].head<3>() *= c[i].w();
+    }
+}
 
-    else if(std::regex_match(name, match, rgb_color)) {
-        int r = std::stoi(match[1]);
-        int g = std::stoi(match[2]);
-        int b = std::stoi(match[3]);
-        return Eigen::Vector4f(r / 255.0f, g / 255.0f, b / 255.0f, 1.0f);
+void Color::premultiply_alpha(std::span<uint8_t> rgba8) {
+    std::ptrdiff_t n = rgba8.size() / 4;
+    uint8_t *c = rgba8.data();
+#pragma omp parallel for if (n > PARALLEL_THRESHOLD)
+    for (std::ptrdiff_t i = 0; i < n; i++) {
+        uint32_t a = c[4 * i + 3];
+        for (int k = 0; k < 3; k++) {
+            c[4 * i + k] = uint8_t((c[4 * i + k] * a + 127) / 255);
+        }
     }
+}
 
-    else if(std::regex_match(name, match, hsl_color)) {
-        int h = std::stoi(match[1]);
-        int s = std::stoi(match[3]);
-        int l = std::stoi(match[4]);
-        float r, g, b;
-        return Color::hsl_to_rgb(Eigen::Vector3f(h, s, l));
+void Color::unpremultiply_alpha(std::span<Eigen::Vector4f> colors) {
+    std::ptrdiff_t n = colors.size();
+    Eigen::Vector4f *c = colors.data();
+#pragma omp parallel for if (n > PARALLEL_THRESHOLD)
+    for (std::ptrdiff_t i = 0; i < n; i++) {
+        float a = c[i].w();
+        c[i].head<3>() *= a > 0.0f ? 1.0f / a : 0.0f;
+    }
+}
+
+void Color::unpremultiply_alpha(std::span<uint8_t> rgba8) {
+    std::ptrdiff_t n = rgba8.size() / 4;
+    uint8_t *c = rgba8.data();
+#pragma omp parallel for if (n > PARALLEL_THRESHOLD)
+    for (std::ptrdiff_t i = 0; i < n; i++) {
+        uint32_t a = c[4 * i + 3];
+        for (int k = 0; k < 3; k++) {
+            c[4 * i + k] = a == 0 ? 0 : uint8_t(std::min<uint32_t>(255, (c[4 * i + k] * 255 + a / 2) / a));
+        }
+    }
+}
+
+// parses "[prefix](a, b, c)" : integer arguments, each one optionally followed by a suffix ("%", "deg" ...)
+static bool parse_function(std::string_view text, std::string_view prefix, int values[3], std::string_view suffixes[3]) {
+    if (text.substr(0, prefix.size()) != prefix) {
+        return false;
+    }
+    size_t i = prefix.size();
+    auto skip_spaces = [&]() {
+        while (i < text.size() && text[i] == ' ') {
+            i++;
+        }
+    };
+    skip_spaces();
+    if (i >= text.size() || text[i++] != '(') {
+        return false;
+    }
+    for (int k = 0; k < 3; k++) {
+        skip_spaces();
+        size_t start = i;
+        int value = 0;
+        while (i < text.size() && std::isdigit((unsigned char)text[i])) {
+            value = value * 10 + (text[i++] - '0');
+        }
+        if (i == start) {
+            return false;
+        }
+        values[k] = value;
+        for (auto suffix : {std::string_view("deg"), std::string_view("%")}) {
+            if (text.substr(i, suffix.size()) == suffix) {
+                suffixes[k] = suffix;
+                i += suffix.size();
+                break;
+            }
+        }
+        skip_spaces();
+        if (i >= text.size() || text[i++] != (k == 2 ? ')' : ',')) {
+            return false;
+        }
+    }
+    return i == text.size();
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c = colornames::fold(c);
+    return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+}
+
+Eigen::Vector4f Color::for_name(const std::string &name) {
+
+    if (auto rgba = rgba32_for_name(name)) {
+        return rgba32_to_floats(*rgba);
+    }
+
+    if ((name.size() == 7 || name.size() == 9) && name[0] == '#') {
+        int components[4] = {0, 0, 0, 255};
+        bool valid = true;
+        for (size_t i = 1; i < name.size(); i += 2) {
+            int high = hex_value(name[i]), low = hex_value(name[i + 1]);
+            valid = valid && high >= 0 && low >= 0;
+            components[i / 2] = high * 16 + low;
+        }
+        if (valid) {
+            return Eigen::Vector4f(components[0], components[1], components[2], components[3]) / 255.0f;
+        }
+    }
+
+    int values[3];
+    std::string_view suffixes[3];
+    if (parse_function(name, "rgb", values, suffixes) && suffixes[0].empty() && suffixes[1].empty() && suffixes[2].empty()) {
+        return Eigen::Vector4f(values[0] / 255.0f, values[1] / 255.0f, values[2] / 255.0f, 1.0f);
+    }
+
+    if (parse_function(name, "hsl", values, suffixes) && suffixes[0] != "%" && suffixes[1] == "%" && suffixes[2] == "%") {
+        return Color::hsl_to_rgb(Eigen::Vector3f(values[0] % 360, values[1] / 100.0f, values[2] / 100.0f));
     }
     throw std::runtime_error("color not found: " + name);
-}
\ No newline at end of file
+}
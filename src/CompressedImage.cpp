@@ -0,0 +1,486 @@
+#include "CompressedImage.hpp"
+#include "FileSystem.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+static const char MAGIC[4] = {'Z', 'B', 'C', 'N'};
+static const uint32_t VERSION = 1;
+
+// a 4x4 block of pixels, expanded to rgba (or to the two raw channels for BC5)
+struct Block
+{
+    uint8_t pixels[16][4];
+};
+
+static void fetch_block(const ConstImageView &view, int bx, int by, bool raw_channels, Block &block)
+{
+    int channels = view.get_channels();
+    for (int i = 0; i < 16; i++)
+    {
+        // blocks overlapping the border repeat the last row / column
+        int x = std::min(bx * 4 + i % 4, view.get_width() - 1);
+        int y = std::min(by * 4 + i / 4, view.get_height() - 1);
+        const uint8_t *pixel = view.get_pixel(x, y);
+        uint8_t *out = block.pixels[i];
+        switch (channels)
+        {
+        case 1:
+            out[0] = out[1] = out[2] = pixel[0];
+            out[3] = 255;
+            break;
+        case 2:
+            if (raw_channels)
+            {
+                out[0] = pixel[0];
+                out[1] = pixel[1];
+                out[2] = 0;
+            }
+            else
+            {
+                out[0] = out[1] = out[2] = pixel[0];
+            }
+            out[3] = pixel[1];
+            break;
+        case 3:
+            memcpy(out, pixel, 3);
+            out[3] = 255;
+            break;
+        default:
+            memcpy(out, pixel, 4);
+        }
+    }
+}
+
+static uint16_t to_565(const Eigen::Vector3f &color)
+{
+    int r = std::clamp(int(std::lround(color.x() * 31.0f / 255.0f)), 0, 31);
+    int g = std::clamp(int(std::lround(color.y() * 63.0f / 255.0f)), 0, 63);
+    int b = std::clamp(int(std::lround(color.z() * 31.0f / 255.0f)), 0, 31);
+    return uint16_t((r << 11) | (g << 5) | b);
+}
+
+static Eigen::Vector3f from_565(uint16_t color)
+{
+    int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+    return Eigen::Vector3f(float((r << 3) | (r >> 2)), float((g << 2) | (g >> 4)), float((b << 3) | (b >> 2)));
+}
+
+static void color_palette(uint16_t c0, uint16_t c1, Eigen::Vector3f palette[4])
+{
+    palette[0] = from_565(c0);
+    palette[1] = from_565(c1);
+    palette[2] = (2.0f * palette[0] + palette[1]) / 3.0f;
+    palette[3] = (palette[0] + 2.0f * palette[1]) / 3.0f;
+}
+
+// picks the nearest palette entry for every pixel, returns the squared error
+static float select_indices(const Eigen::Vector3f colors[16], uint16_t c0, uint16_t c1, uint8_t indices[16])
+{
+    Eigen::Vector3f palette[4];
+    color_palette(c0, c1, palette);
+    float error = 0.0f;
+    for (int i = 0; i < 16; i++)
+    {
+        float best = std::numeric_limits<float>::max();
+        for (int k = 0; k < 4; k++)
+        {
+            float d = (colors[i] - palette[k]).squaredNorm();
+            if (d < best)
+            {
+                best = d;
+                indices[i] = uint8_t(k);
+            }
+        }
+        error += best;
+    }
+    return error;
+}
+
+static void encode_color_block(const Block &block, uint8_t *out)
+{
+    Eigen::Vector3f colors[16];
+    Eigen::Vector3f mean = Eigen::Vector3f::Zero();
+    for (int i = 0; i < 16; i++)
+    {
+        colors[i] = Eigen::Vector3f(block.pixels[i][0], block.pixels[i][1], block.pixels[i][2]);
+        mean += colors[i];
+    }
+    mean /= 16.0f;
+
+    // principal axis of the colors, by power iteration on the covariance
+    Eigen::Matrix3f covariance = Eigen::Matrix3f::Zero();
+    for (auto &color : colors)
+    {
+        Eigen::Vector3f d = color - mean;
+        covariance += d * d.transpose();
+    }
+    Eigen::Vector3f axis(1.0f, 1.0f, 1.0f);
+    for (int i = 0; i < 8; i++)
+    {
+        Eigen::Vector3f next = covariance * axis;
+        float norm = next.norm();
+        if (norm < 1e-6f)
+        {
+            break;
+        }
+        axis = next / norm;
+    }
+
+    // the extreme colors along the axis are the first endpoints
+    float lowest = std::numeric_limits<float>::max(), highest = std::numeric_limits<float>::lowest();
+    Eigen::Vector3f min_color = mean, max_color = mean;
+    for (auto &color : colors)
+    {
+        float t = (color - mean).dot(axis);
+        if (t < lowest)
+        {
+            lowest = t;
+            min_color = color;
+        }
+        if (t > highest)
+        {
+            highest = t;
+            max_color = color;
+        }
+    }
+
+    uint16_t c0 = to_565(max_color), c1 = to_565(min_color);
+    uint8_t indices[16];
+    float error = select_indices(colors, c0, c1, indices);
+
+    // least squares refinement of the endpoints, given the selected indices
+    static const float weights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+    float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+    Eigen::Vector3f ax = Eigen::Vector3f::Zero(), bx = Eigen::Vector3f::Zero();
+    for (int i = 0; i < 16; i++)
+    {
+        float a = weights[indices[i]], b = 1.0f - a;
+        aa += a * a;
+        bb += b * b;
+        ab += a * b;
+        ax += a * colors[i];
+        bx += b * colors[i];
+    }
+    float determinant = aa * bb - ab * ab;
+    if (std::abs(determinant) > 1e-6f)
+    {
+        uint16_t r0 = to_565((ax * bb - bx * ab) / determinant);
+        uint16_t r1 = to_565((bx * aa - ax * ab) / determinant);
+        uint8_t refined[16];
+        float refined_error = select_indices(colors, r0, r1, refined);
+        if (refined_error < error)
+        {
+            c0 = r0;
+            c1 = r1;
+            memcpy(indices, refined, 16);
+        }
+    }
+
+    // c0 > c1 selects the 4 colors mode, swapping the endpoints swaps the indices 0 <-> 1 and 2 <-> 3
+    if (c0 < c1)
+    {
+        std::swap(c0, c1);
+        for (auto &index : indices)
+        {
+            index ^= 1;
+        }
+    }
+    else if (c0 == c1)
+    {
+        memset(indices, 0, 16);
+    }
+
+    uint32_t bits = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        bits |= uint32_t(indices[i]) << (2 * i);
+    }
+    memcpy(out, &c0, 2);
+    memcpy(out + 2, &c1, 2);
+    memcpy(out + 4, &bits, 4);
+}
+
+static void encode_channel_block(const Block &block, int channel, uint8_t *out)
+{
+    uint8_t a0 = 0, a1 = 255;
+    for (auto &pixel : block.pixels)
+    {
+        a0 = std::max(a0, pixel[channel]);
+        a1 = std::min(a1, pixel[channel]);
+    }
+
+    // a0 > a1 selects the 8 values mode : index 0 is a0, 1 is a1, 2..7 are interpolated from a0 to a1
+    uint64_t bits = 0;
+    if (a0 > a1)
+    {
+        for (int i = 0; i < 16; i++)
+        {
+            int level = int(std::lround((block.pixels[i][channel] - a1) * 7.0f / (a0 - a1)));
+            uint64_t index = level == 7 ? 0 : level == 0 ? 1 : 8 - level;
+            bits |= index << (3 * i);
+        }
+    }
+    out[0] = a0;
+    out[1] = a1;
+    for (int i = 0; i < 6; i++)
+    {
+        out[2 + i] = uint8_t(bits >> (8 * i));
+    }
+}
+
+static void decode_channel_block(const uint8_t *in, Block &block, int channel)
+{
+    int a0 = in[0], a1 = in[1];
+    int palette[8] = {a0, a1};
+    if (a0 > a1)
+    {
+        for (int i = 1; i < 7; i++)
+        {
+            palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+        }
+    }
+    else
+    {
+        for (int i = 1; i < 5; i++)
+        {
+            palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+    uint64_t bits = 0;
+    for (int i = 0; i < 6; i++)
+    {
+        bits |= uint64_t(in[2 + i]) << (8 * i);
+    }
+    for (int i = 0; i < 16; i++)
+    {
+        block.pixels[i][channel] = uint8_t(palette[(bits >> (3 * i)) & 7]);
+    }
+}
+
+// only bc1 has the 3 colors mode (c0 <= c1), bc3 color blocks always use 4 colors
+static void decode_color_block(const uint8_t *in, Block &block, bool three_color_allowed)
+{
+    uint16_t c0, c1;
+    uint32_t bits;
+    memcpy(&c0, in, 2);
+    memcpy(&c1, in + 2, 2);
+    memcpy(&bits, in + 4, 4);
+    Eigen::Vector3f palette[4];
+    color_palette(c0, c1, palette);
+    if (three_color_allowed && c0 <= c1)
+    {
+        palette[2] = (palette[0] + palette[1]) / 2.0f;
+        palette[3] = Eigen::Vector3f::Zero();
+    }
+    for (int i = 0; i < 16; i++)
+    {
+        const Eigen::Vector3f &color = palette[(bits >> (2 * i)) & 3];
+        for (int c = 0; c < 3; c++)
+        {
+            block.pixels[i][c] = uint8_t(std::lround(color[c]));
+        }
+    }
+}
+
+CompressedImage::Format CompressedImage::get_default_format(int channels)
+{
+    switch (channels)
+    {
+    case 1:
+        return Format::BC4;
+    case 2:
+        return Format::BC5;
+    case 3:
+        return Format::BC1;
+    case 4:
+        return Format::BC3;
+    default:
+        throw std::invalid_argument("invalid number of channels");
+    }
+}
+
+size_t CompressedImage::get_block_size() const
+{
+    return format == Format::BC1 || format == Format::BC4 ? 8 : 16;
+}
+
+int CompressedImage::get_channels() const
+{
+    switch (format)
+    {
+    case Format::BC4:
+        return 1;
+    case Format::BC5:
+        return 2;
+    case Format::BC1:
+        return 3;
+    default:
+        return 4;
+    }
+}
+
+CompressedImage CompressedImage::encode(const ConstImageView &view)
+{
+    return encode(view, get_default_format(view.get_channels()));
+}
+
+CompressedImage CompressedImage::encode(const ConstImageView &view, Format format)
+{
+    CompressedImage compressed;
+    compressed.format = format;
+    compressed.dimensions = view.get_dimensions();
+    int blocks_x = (view.get_width() + 3) / 4;
+    int blocks_y = (view.get_height() + 3) / 4;
+    size_t block_size = compressed.get_block_size();
+    compressed.data.resize(size_t(blocks_x) * blocks_y * block_size);
+    if (view.get_width() == 0 || view.get_height() == 0)
+    {
+        return compressed;
+    }
+
+#pragma omp parallel for schedule(dynamic)
+    for (int by = 0; by < blocks_y; by++)
+    {
+        Block block;
+        for (int bx = 0; bx < blocks_x; bx++)
+        {
+            fetch_block(view, bx, by, format == Format::BC5, block);
+            uint8_t *out = compressed.data.data() + (size_t(by) * blocks_x + bx) * block_size;
+            switch (format)
+            {
+            case Format::BC1:
+                encode_color_block(block, out);
+                break;
+            case Format::BC3:
+                encode_channel_block(block, 3, out);
+                encode_color_block(block, out + 8);
+                break;
+            case Format::BC4:
+                encode_channel_block(block, 0, out);
+                break;
+            case Format::BC5:
+                encode_channel_block(block, 0, out);
+                encode_channel_block(block, 1, out + 8);
+                break;
+            }
+        }
+    }
+    return compressed;
+}
+
+Image CompressedImage::decode() const
+{
+    int channels = get_channels();
+    Image image(dimensions.x(), dimensions.y(), channels);
+    ImageView view = image.view();
+    int blocks_x = (dimensions.x() + 3) / 4;
+    int blocks_y = (dimensions.y() + 3) / 4;
+    size_t block_size = get_block_size();
+    for (int by = 0; by < blocks_y; by++)
+    {
+        for (int bx = 0; bx < blocks_x; bx++)
+        {
+            const uint8_t *in = data.data() + (size_t(by) * blocks_x + bx) * block_size;
+            Block block;
+            switch (format)
+            {
+            case Format::BC1:
+                decode_color_block(in, block, true);
+                break;
+            case Format::BC3:
+                decode_channel_block(in, block, 3);
+                decode_color_block(in + 8, block, false);
+                break;
+            case Format::BC4:
+                decode_channel_block(in, block, 0);
+                break;
+            case Format::BC5:
+                decode_channel_block(in, block, 0);
+                decode_channel_block(in + 8, block, 1);
+                break;
+            }
+            for (int i = 0; i < 16; i++)
+            {
+                int x = bx * 4 + i % 4, y = by * 4 + i / 4;
+                if (x < dimensions.x() && y < dimensions.y())
+                {
+                    memcpy(view.get_pixel(x, y), block.pixels[i], channels);
+                }
+            }
+        }
+    }
+    return image;
+}
+
+// magic, version, format, width, height
+static const size_t HEADER_SIZE = 20;
+
+Blob CompressedImage::serialize() const
+{
+    Blob blob(HEADER_SIZE + data.size());
+    uint8_t *out = blob.as<uint8_t *>();
+    uint32_t header[4] = {VERSION, uint32_t(format), uint32_t(dimensions.x()), uint32_t(dimensions.y())};
+    memcpy(out, MAGIC, 4);
+    memcpy(out + 4, header, sizeof(header));
+    memcpy(out + HEADER_SIZE, data.data(), data.size());
+    return blob;
+}
+
+CompressedImage CompressedImage::deserialize(const Blob &blob)
+{
+    const uint8_t *in = blob.as<const uint8_t *>();
+    if (blob.get_size() < HEADER_SIZE || memcmp(in, MAGIC, 4) != 0)
+    {
+        throw std::runtime_error("not a compressed image");
+    }
+    uint32_t header[4];
+    memcpy(header, in + 4, sizeof(header));
+    if (header[0] != VERSION || header[1] > uint32_t(Format::BC5))
+    {
+        throw std::runtime_error("unsupported compressed image version");
+    }
+    CompressedImage compressed;
+    compressed.format = Format(header[1]);
+    compressed.dimensions = Eigen::Vector2i(int(header[2]), int(header[3]));
+    size_t expected = size_t((header[2] + 3) / 4) * ((header[3] + 3) / 4) * compressed.get_block_size();
+    if (blob.get_size() != HEADER_SIZE + expected)
+    {
+        throw std::runtime_error("truncated compressed image");
+    }
+    compressed.data.assign(in + HEADER_SIZE, in + HEADER_SIZE + expected);
+    return compressed;
+}
+
+CompressedImage CompressedImage::encode_cached(const Image &image, Format format, const std::string &cache_directory)
+{
+    static const char *extensions[] = {"bc1", "bc3", "bc4", "bc5"};
+    std::string uri = cache_directory + "/" + image.get_hash() + "." + extensions[int(format)];
+    auto entry = FileSystem::get_entry(uri);
+    if (entry->exists())
+    {
+        try
+        {
+            CompressedImage cached = deserialize(entry->read());
+            if (cached.format == format && cached.dimensions == image.get_dimensions())
+            {
+                return cached;
+            }
+        }
+        catch (const std::runtime_error &)
+        {
+            // corrupted or outdated, encoded again below
+        }
+    }
+    CompressedImage compressed = encode(image.view(), format);
+    if (!entry->is_readonly())
+    {
+        entry->write(compressed.serialize());
+    }
+    return compressed;
+}
@@ -1,8 +1,8 @@
 #include "Cubemap.hpp"
-#include "FileSystem.hpp"
-#include "stb_image.h"
+#include "Image.hpp"
+#include "Texture.hpp"
+#include "GLState.hpp"
 #include <cassert>
-#include <cstring>
 #include <stdexcept>
 
 #include <GL/glew.h>
@@ -28,28 +28,21 @@
  *        +------+
 */
 Cubemap::Cubemap(const std::string& path) {
-    Blob blob = FileSystem::get_entry(path)->read();
-
-    glGenTextures(1, &id);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, id);
-
-    int image_width, image_height;
-    stbi_uc* data = stbi_load_from_memory(blob.as<stbi_uc*>(), blob.get_size(), &image_width, &image_height, &channels, 0);
-    if(!data) {
-        glDeleteTextures(1, &id);
-        throw std::runtime_error("Failed to load texture: " + path);
-    }
+    Image image = Image::load(path);
+    channels = image.get_channels();
 
+    int image_width = image.get_dimensions().x();
+    int image_height = image.get_dimensions().y();
     assert(image_width % 4 == 0 && "Cubemap width must be a multiple of 4");
     face_size = image_width / 4;
     assert(face_size == image_height / 3 && "Cubemap width must be 3 times its height");
 
-    stbi_uc* tmp = new stbi_uc[face_size * face_size * channels];
+    glGenTextures(1, &id);
+    GLState::get_instance().bind_texture(GL_TEXTURE_CUBE_MAP, id);
+
+    // the faces are uploaded straight from the big image
     auto assignTexture = [&](GLenum role, int x, int y) {
-        for(int i = 0; i < face_size; i++) {
-            memcpy(tmp + i * face_size * channels, data + ((y + i) * image_width + x) * channels, face_size * channels);
-        }
-        glTexImage2D(role, 0, channels==4 ? GL_RGBA : GL_RGB, face_size, face_size, 0, GL_RGB, GL_UNSIGNED_BYTE, tmp);
+        Texture::upload(role, image.view(x, y, face_size, face_size));
     };
     
     assignTexture(GL_TEXTURE_CUBE_MAP_POSITIVE_X, face_size * 2, face_size);
@@ -59,23 +52,18 @@ Cubemap::Cubemap(const std::string& path) {
     assignTexture(GL_TEXTURE_CUBE_MAP_POSITIVE_Z, face_size, face_size);
     assignTexture(GL_TEXTURE_CUBE_MAP_NEGATIVE_Z, face_size * 3, face_size);
 
-    delete[] tmp;
-
-
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-    stbi_image_free(data);
 }
 
 Cubemap::~Cubemap() {
+    GLState::get_instance().forget_texture(id);
     glDeleteTextures(1, &id);
 }
 
 void Cubemap::attach(uint32_t slot) {
-    glActiveTexture(GL_TEXTURE0 + slot);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, id);
+    GLState::get_instance().bind_texture(slot, GL_TEXTURE_CUBE_MAP, id);
 }
\ No newline at end of file
@@ -1,17 +1,16 @@
 #include "DrawCubePass.hpp"
-#include "Geometry.hpp"
 
 
 DrawCubePass::DrawCubePass()
 {
 
     vao.set_program(
-        R"(
+        std::string(R"(
         #version 460 core
+        )") + RenderingSystem::GLSL_CAMERA_BLOCK + R"(
         layout(location = 0) in vec3 position;
-        layout(location = 0) uniform mat4 mvp;
         void main() {
-            gl_Position = mvp * vec4(position, 1.0);
+            gl_Position = view_projection * vec4(position, 1.0); // no model, just the cube geometry 1*1*1 centered at 0,0,0
         }
     )",
         R"(
@@ -22,17 +21,13 @@ DrawCubePass::DrawCubePass()
         }
     )");
 
-    Geometry cube = basegeometries::cube();
-
-    vao.bind_buffer(0, cube.vertices);
-    vao.set_ebo(cube.indices);
+    auto &registry = MeshRegistry::get_instance();
+    cube = registry.get_or_create("basegeometries::cube", basegeometries::cube);
+    registry.bind(vao, *cube);
 }
 
 
 void DrawCubePass::execute()
 {
-    auto camera = get_rendering_system()->get_camera();
-    Eigen::Matrix4f mvp = camera->get_projection() * camera->get_view(); // no model, just the cube geometry 1*1*1 centered at 0,0,0
-    vao.get_shader_program()->set_uniform("mvp", mvp); // TODO get_shader_program() => get_program() ?
     vao.render();
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -62,6 +62,16 @@ public:
         return result;
     }
 
+    std::unique_ptr<std::istream> open() override
+    {
+        auto file = std::make_unique<std::ifstream>(path.string().c_str(), std::ios::binary);
+        if (!*file)
+        {
+            throw std::runtime_error("Failed to open file '" + path.string() + "' for reading");
+        }
+        return file;
+    }
+
     void write(const void *data, size_t size) override
     {
         bool done = false;
@@ -96,12 +106,60 @@ public:
         return false;
     }
 
+    void create_directories() override
+    {
+        std::error_code error;
+        fs::create_directories(path, error);
+        if (error || !fs::is_directory(path))
+        {
+            throw std::runtime_error("Failed to create directory '" + path.string() + "'");
+        }
+    }
+
     virtual long last_modified() override
     {
         return fs::last_write_time(path).time_since_epoch().count();
     }
 };
 
+/**
+ * a read-only stream over a memory area
+ */
+struct MemoryStreamBuf : public std::streambuf
+{
+    MemoryStreamBuf(void *ptr, size_t size)
+    {
+        char *begin = reinterpret_cast<char *>(ptr);
+        setg(begin, begin, begin + size);
+    }
+
+    pos_type seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+    {
+        char *base = dir == std::ios_base::beg ? eback() : dir == std::ios_base::cur ? gptr() : egptr();
+        char *target = base + offset;
+        if (!(which & std::ios_base::in) || target < eback() || target > egptr())
+        {
+            return pos_type(off_type(-1));
+        }
+        setg(eback(), target, egptr());
+        return pos_type(target - eback());
+    }
+
+    pos_type seekpos(pos_type position, std::ios_base::openmode which) override
+    {
+        return seekoff(off_type(position), std::ios_base::beg, which);
+    }
+};
+
+struct MemoryIStream : public std::istream
+{
+    MemoryStreamBuf buf;
+    MemoryIStream(void *ptr, size_t size) : std::istream(nullptr), buf(ptr, size)
+    {
+        rdbuf(&buf);
+    }
+};
+
 class SymbolFsEntry : public FsEntry
 {
     std::string symbol;
@@ -171,6 +229,11 @@ public:
         return Blob(resolved, size);
     }
 
+    std::unique_ptr<std::istream> open() override
+    {
+        return std::make_unique<MemoryIStream>(resolved, size);
+    }
+
     void write(const void* data, size_t size) override
     {
         throw std::runtime_error("read-only");
@@ -181,6 +244,11 @@ public:
         return true;
     }
 
+    void create_directories() override
+    {
+        throw std::runtime_error("read-only");
+    }
+
     virtual long last_modified() override
     {
         return 0;
@@ -210,9 +278,7 @@ std::shared_ptr<FsEntry> FileSystem::get_entry(const std::string &uri)
     // 'normal' disk file
     if (uri.starts_with("file://"))
     {
-        std::string path = uri.substr(7);
-        path = strutil::replace_all(path, "/", std::to_string(fs::path::preferred_separator));
-        return std::make_shared<DiskFsEntry>(path);
+        return std::make_shared<DiskFsEntry>(fs::path(uri.substr(7)).make_preferred().string());
     }
 
     if (uri.starts_with("symbol://"))
@@ -0,0 +1,39 @@
+#include "FrameStats.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+#include <fmt/format.h>
+
+// nearest rank percentile of sorted samples
+static double get_percentile(const std::vector<double> &sorted, double percentile)
+{
+    size_t rank = size_t(std::ceil(percentile / 100.0 * sorted.size()));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+FrameStats FrameStats::from_samples(std::vector<double> samples)
+{
+    FrameStats stats;
+    if (samples.empty())
+    {
+        return stats;
+    }
+    std::sort(samples.begin(), samples.end());
+    size_t count = samples.size();
+    stats.frames = count;
+    stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / count;
+    stats.median = count % 2 ? samples[count / 2] : (samples[count / 2 - 1] + samples[count / 2]) / 2.0;
+    stats.p95 = get_percentile(samples, 95.0);
+    stats.p99 = get_percentile(samples, 99.0);
+    stats.min = samples.front();
+    stats.max = samples.back();
+    return stats;
+}
+
+std::string FrameStats::to_string() const
+{
+    return fmt::format("{} frames : mean {:.2f}ms, median {:.2f}ms, p95 {:.2f}ms, p99 {:.2f}ms, min {:.2f}ms, max {:.2f}ms",
+                       frames, mean, median, p95, p99, min, max);
+}
@@ -0,0 +1,238 @@
+#include "GLState.hpp"
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+GLState &GLState::get_instance()
+{
+    static GLState instance;
+    return instance;
+}
+
+bool GLState::update(uint32_t &cached, uint32_t value)
+{
+    if (cached == value)
+    {
+        counters.skipped++;
+        return false;
+    }
+    cached = value;
+    counters.issued++;
+    return true;
+}
+
+void GLState::use_program(uint32_t program)
+{
+    if (update(this->program, program))
+    {
+        glUseProgram(program);
+    }
+}
+
+void GLState::bind_vertex_array(uint32_t vertex_array)
+{
+    if (update(this->vertex_array, vertex_array))
+    {
+        glBindVertexArray(vertex_array);
+        // the element buffer binding comes with the vertex array
+        buffers.erase(GL_ELEMENT_ARRAY_BUFFER);
+    }
+}
+
+void GLState::bind_buffer(uint32_t target, uint32_t buffer)
+{
+    auto it = buffers.try_emplace(target, UNKNOWN).first;
+    if (update(it->second, buffer))
+    {
+        glBindBuffer(target, buffer);
+    }
+}
+
+void GLState::bind_buffer_base(uint32_t target, uint32_t index, uint32_t buffer)
+{
+    auto it = indexed_buffers.try_emplace({target, index}, UNKNOWN).first;
+    if (update(it->second, buffer))
+    {
+        glBindBufferBase(target, index, buffer);
+        buffers[target] = buffer;
+    }
+}
+
+void GLState::bind_buffer_range(uint32_t target, uint32_t index, uint32_t buffer, size_t offset, size_t size)
+{
+    glBindBufferRange(target, index, buffer, offset, size);
+    counters.issued++;
+    // a later bind_buffer_base of the same buffer has to reset the range
+    indexed_buffers[{target, index}] = UNKNOWN;
+    buffers[target] = buffer;
+}
+
+void GLState::set_active_texture(uint32_t unit)
+{
+    if (update(active_unit, unit))
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+}
+
+void GLState::bind_texture(uint32_t target, uint32_t texture)
+{
+    if (active_unit == UNKNOWN)
+    {
+        // the active unit has to be known for the binding to be tracked
+        set_active_texture(0);
+    }
+    auto it = textures.try_emplace({active_unit, target}, UNKNOWN).first;
+    if (update(it->second, texture))
+    {
+        glBindTexture(target, texture);
+    }
+}
+
+void GLState::bind_texture(uint32_t unit, uint32_t target, uint32_t texture)
+{
+    auto it = textures.find({unit, target});
+    if (it != textures.end() && it->second == texture)
+    {
+        counters.skipped++;
+        return;
+    }
+    set_active_texture(unit);
+    bind_texture(target, texture);
+}
+
+void GLState::set_enabled(uint32_t capability, bool enabled)
+{
+    auto it = capabilities.find(capability);
+    if (it != capabilities.end() && it->second == enabled)
+    {
+        counters.skipped++;
+        return;
+    }
+    capabilities[capability] = enabled;
+    counters.issued++;
+    if (enabled)
+    {
+        glEnable(capability);
+    }
+    else
+    {
+        glDisable(capability);
+    }
+}
+
+void GLState::set_depth_func(uint32_t func)
+{
+    if (update(depth_func, func))
+    {
+        glDepthFunc(func);
+    }
+}
+
+void GLState::set_depth_mask(bool enabled)
+{
+    if (update(depth_mask, enabled))
+    {
+        glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+    }
+}
+
+void GLState::set_cull_face(uint32_t mode)
+{
+    if (update(cull_face, mode))
+    {
+        glCullFace(mode);
+    }
+}
+
+void GLState::set_blend_func(uint32_t source, uint32_t destination)
+{
+    if (blend_source == source && blend_destination == destination)
+    {
+        counters.skipped++;
+        return;
+    }
+    blend_source = source;
+    blend_destination = destination;
+    counters.issued++;
+    glBlendFunc(source, destination);
+}
+
+void GLState::forget_program(uint32_t program)
+{
+    // a deleted program stays in use until another one is used, but its name may be given to a new program
+    if (this->program == program)
+    {
+        this->program = UNKNOWN;
+    }
+}
+
+void GLState::forget_vertex_array(uint32_t vertex_array)
+{
+    if (this->vertex_array == vertex_array)
+    {
+        this->vertex_array = 0;
+        buffers.erase(GL_ELEMENT_ARRAY_BUFFER);
+    }
+}
+
+void GLState::forget_buffer(uint32_t buffer)
+{
+    for (auto &[target, bound] : buffers)
+    {
+        if (bound == buffer)
+        {
+            bound = 0;
+        }
+    }
+    for (auto &[binding, bound] : indexed_buffers)
+    {
+        if (bound == buffer)
+        {
+            bound = 0;
+        }
+    }
+}
+
+void GLState::forget_texture(uint32_t texture)
+{
+    for (auto &[binding, bound] : textures)
+    {
+        if (bound == texture)
+        {
+            bound = 0;
+        }
+    }
+}
+
+void GLState::invalidate()
+{
+    program = UNKNOWN;
+    vertex_array = UNKNOWN;
+    active_unit = UNKNOWN;
+    buffers.clear();
+    indexed_buffers.clear();
+    textures.clear();
+    capabilities.clear();
+    depth_func = UNKNOWN;
+    cull_face = UNKNOWN;
+    blend_source = UNKNOWN;
+    blend_destination = UNKNOWN;
+    depth_mask = UNKNOWN;
+}
+
+void GLState::new_frame()
+{
+    last_frame = counters;
+    counters = Counters();
+}
+
+GLState::Counters GLState::get_counters() const
+{
+    return counters;
+}
+
+GLState::Counters GLState::get_last_frame_counters() const
+{
+    return last_frame;
+}
@@ -1,4 +1,5 @@
 #include "Geometry.hpp"
+#include "Md5.hpp"
 #include <fmt/format.h>
 
 void Geometry::recompute_normals()
@@ -72,6 +73,7 @@ void Geometry::merge(const Geometry &other)
     builder.add_geometry(other);
     *this = builder.build();
     normals.clear();
+    invalidate_adjacency();
 }
 
 Geometry Geometry::transformed(const Eigen::Matrix4f &transform) const
@@ -87,6 +89,7 @@ Geometry Geometry::copy() const
     copy.vertices = vertices;
     copy.indices = indices;
     copy.normals = normals;
+    copy.adjacency = adjacency; // immutable, safe to share
     return copy;
 }
 
@@ -154,6 +157,42 @@ Eigen::Vector3f Geometry::get_centroid() const
     return centroid;
 }
 
+std::shared_ptr<const MeshAdjacency> Geometry::get_adjacency() const
+{
+    auto is_current = [this](const std::shared_ptr<const MeshAdjacency> &candidate)
+    {
+        return candidate && candidate->get_halfedge_count() == indices.size() && candidate->get_vertex_count() == vertices.size();
+    };
+    std::shared_ptr<const MeshAdjacency> current = adjacency.value.load();
+    if (is_current(current))
+    {
+        return current;
+    }
+    // built without holding anything, if another thread published first its adjacency is used instead
+    auto built = std::make_shared<const MeshAdjacency>(indices, vertices.size());
+    if (!adjacency.value.compare_exchange_strong(current, built) && is_current(current))
+    {
+        return current;
+    }
+    return built;
+}
+
+void Geometry::invalidate_adjacency()
+{
+    adjacency.value.store(nullptr);
+}
+
+std::string Geometry::get_hash() const
+{
+    Md5Digest md5;
+    uint64_t sizes[3] = {vertices.size(), indices.size(), normals.size()};
+    md5.update(sizes, sizeof(sizes));
+    md5.update(vertices.data(), vertices.size() * sizeof(Eigen::Vector3f));
+    md5.update(indices.data(), indices.size() * sizeof(uint32_t));
+    md5.update(normals.data(), normals.size() * sizeof(Eigen::Vector3f));
+    return md5.hexdigest();
+}
+
 static inline float sign(const Eigen::Vector2f &p1, const Eigen::Vector2f &p2, const Eigen::Vector2f &p3)
 {
     return (p1.x() - p3.x()) * (p2.y() - p3.y()) - (p2.x() - p3.x()) * (p1.y() - p3.y());
@@ -319,12 +358,12 @@ namespace basegeometries
 
     Geometry triangle(const Eigen::Vector3f &a, const Eigen::Vector3f &b, const Eigen::Vector3f &c)
     {
-        return Geometry{{a, b, c}, {0, 1, 2}};
+        return Geometry{{a, b, c}, {0, 1, 2}, {}, {}};
     }
 
     Geometry quad(const Eigen::Vector3f &a, const Eigen::Vector3f &b, const Eigen::Vector3f &c, const Eigen::Vector3f &d)
     {
-        return Geometry{{a, b, c, d}, {0, 1, 2, 2, 3, 0}};
+        return Geometry{{a, b, c, d}, {0, 1, 2, 2, 3, 0}, {}, {}};
     }
 
     Geometry cube()
@@ -347,7 +386,9 @@ namespace basegeometries
                 4, 0, 3, 3, 7, 4, // left
                 3, 2, 6, 6, 7, 3, // top
                 4, 5, 1, 1, 0, 4, // bottom
-            }};
+            },
+            {},
+            {}};
     }
 
     Geometry disc(int n)
@@ -382,7 +423,7 @@ namespace basegeometries
                 indices.push_back(i + 1);
                 indices.push_back((i + 1) % n + 1);
             }
-            return {vertices, indices};
+            return {vertices, indices, {}, {}};
         }
     }
 
@@ -1,9 +1,17 @@
 #include "Image.hpp"
 #include "strutil.hpp"
 #include "FileSystem.hpp"
+#include "ThreadPool.hpp"
+#include "ImageKernels.hpp"
+#include "Md5.hpp"
+#include "Srgb.hpp"
+
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <vector>
 
 #include "stb_image.h"
-#include "stb_image_resize.h"
 #include "stb_image_write.h"
 
 Image::~Image()
@@ -11,17 +19,51 @@ Image::~Image()
     deleter(data);
 }
 
-Image::Image(int width, int height, int channels)
+Image::Image(int width, int height, int channels_) : dimensions(width, height), channels(channels_)
 {
     assert(channels > 0 && channels <= 4);
-    Image image;
-    image.dimensions = Eigen::Vector2i(width, height);
-    image.channels = channels;
-    image.data = (uint8_t*) malloc(width * height * channels);
-    image.deleter = [](void *data)
+    data = (uint8_t *)malloc(size_t(width) * height * channels);
+    if (data == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    deleter = [](void *data)
     { free(data); };
 }
 
+Image::Image(const ConstImageView &view) : Image(view.get_width(), view.get_height(), view.get_channels())
+{
+    view.copy_to(data);
+}
+
+Image::Image(Image &&other) : data(other.data), dimensions(other.dimensions), channels(other.channels), deleter(other.deleter)
+{
+    other.data = nullptr;
+    other.deleter = [](void *) {};
+}
+
+Image &Image::operator=(Image &&other)
+{
+    if (this != &other)
+    {
+        deleter(data);
+        data = other.data;
+        dimensions = other.dimensions;
+        channels = other.channels;
+        deleter = other.deleter;
+        other.data = nullptr;
+        other.deleter = [](void *) {};
+    }
+    return *this;
+}
+
+Image Image::copy() const
+{
+    Image image(dimensions.x(), dimensions.y(), channels);
+    memcpy(image.data, data, get_size());
+    return image;
+}
+
 Image Image::load(const std::string &filename)
 {
     return load(FileSystem::get_entry(filename)->read());
@@ -44,161 +86,82 @@ Image Image::load(const Blob &data)
     return image;
 }
 
-struct Rgb
+ImageView Image::view()
 {
-    uint8_t r, g, b;
-    Rgb() = default;
-    Rgb(int value)
-    {
-        r = value >> 16;
-        g = value >> 8;
-        b = value;
-    }
-};
+    return ImageView(data, dimensions.x(), dimensions.y(), channels);
+}
 
-struct Rgba
+ConstImageView Image::view() const
 {
-    uint8_t r, g, b, a;
-    Rgba() = default;
-    Rgba(int value)
-    {
-        r = value >> 24;
-        g = value >> 16;
-        b = value >> 8;
-        a = value;
-    }
-};
+    return ConstImageView(data, dimensions.x(), dimensions.y(), channels);
+}
 
-#define CROPPED(TYPE)                                                                                                  \
-    Eigen::Map<Eigen::Matrix<TYPE, Eigen::Dynamic, Eigen::Dynamic>> src((TYPE *)data, dimensions.y(), dimensions.x()); \
-    src.block(y, x, height, width).swap(Eigen::Map<Eigen::Matrix<TYPE, Eigen::Dynamic, Eigen::Dynamic>>((TYPE *)cropped_image.data, height, width));
+ImageView Image::view(int x, int y, int width, int height)
+{
+    return view().sub(x, y, width, height);
+}
+
+ConstImageView Image::view(int x, int y, int width, int height) const
+{
+    return view().sub(x, y, width, height);
+}
 
 Image Image::cropped(int x, int y, int width, int height) const
 {
-    Image cropped_image(width, height, channels);
-    if (channels == 1)
-    {
-        CROPPED(uint8_t)
-    }
-    else if (channels == 2)
-    {
-        CROPPED(uint16_t)
-    }
-    else if (channels == 3)
-    {
-        CROPPED(Rgb)
-    }
-    else if (channels == 4)
-    {
-        CROPPED(Rgba)
-    }
-    return cropped_image;
+    return Image(view(x, y, width, height));
 }
 
-Image Image::resized(int width, int height) const
+Image Image::resized(int width, int height, bool srgb) const
 {
     Image resized_image(width, height, channels);
-    stbir_resize_uint8((uint8_t *)data, dimensions.x(), dimensions.y(), 0, (uint8_t *)resized_image.data, width, height, 0, channels);
+    imagekernels::resample(view(), resized_image.view(), srgb);
     return resized_image;
 }
 
-#define FLIP_V(TYPE)                                                                                                   \
-    Eigen::Map<Eigen::Matrix<TYPE, Eigen::Dynamic, Eigen::Dynamic>> mat((TYPE *)data, dimensions.x(), dimensions.y()); \
-    mat.colwise().reverseInPlace();
-
-void Image::flip_horizontally()
+std::vector<Image> Image::build_mip_chain(bool srgb) const
 {
-    if (channels == 1)
-    {
-        FLIP_V(uint8_t)
-    }
-    else if (channels == 2)
-    {
-        FLIP_V(uint16_t)
-    }
-    else if (channels == 3)
-    {
-        FLIP_V(Rgb)
-    }
-    else if (channels == 4)
+    std::vector<Image> levels;
+    const Image *previous = this;
+    while (previous->dimensions.x() > 1 || previous->dimensions.y() > 1)
     {
-        FLIP_V(Rgba)
+        Eigen::Vector2i size = previous->dimensions.cwiseQuotient(Eigen::Vector2i(2, 2)).cwiseMax(1);
+        levels.push_back(previous->resized(size.x(), size.y(), srgb));
+        previous = &levels.back();
     }
+    return levels;
 }
 
-#define FLIP_H(TYPE)                                                                                                   \
-    Eigen::Map<Eigen::Matrix<TYPE, Eigen::Dynamic, Eigen::Dynamic>> mat((TYPE *)data, dimensions.x(), dimensions.y()); \
-    mat.rowwise().reverseInPlace();
+void Image::flip_horizontally()
+{
+    imagekernels::flip_horizontally(view());
+}
 
 void Image::flip_vertically()
 {
-    if (channels == 1)
-    {
-        FLIP_H(uint8_t)
-    }
-    else if (channels == 2)
-    {
-        FLIP_H(uint16_t)
-    }
-    else if (channels == 3)
-    {
-        FLIP_H(Rgb)
-    }
-    else if (channels == 4)
-    {
-        FLIP_H(Rgba)
-    }
+    imagekernels::flip_vertically(view());
 }
 
-#define ROT_CW(TYPE)                                                                                                   \
-    Eigen::Map<Eigen::Matrix<TYPE, Eigen::Dynamic, Eigen::Dynamic>> mat((TYPE *)data, dimensions.x(), dimensions.y()); \
-    mat.transposeInPlace();
-
 void Image::rotate_clockwise()
 {
-    if (channels == 1)
-    {
-        ROT_CW(uint8_t)
-    }
-    else if (channels == 2)
-    {
-        ROT_CW(uint16_t)
-    }
-    else if (channels == 3)
-    {
-        ROT_CW(Rgb)
-    }
-    else if (channels == 4)
-    {
-        ROT_CW(Rgba)
-    }
-    dimensions = Eigen::Vector2i(dimensions.y(), dimensions.x());
+    Image rotated(dimensions.y(), dimensions.x(), channels);
+    imagekernels::rotate_clockwise(view(), rotated.view());
+    *this = std::move(rotated);
 }
 
-#define ROT_CCW(TYPE)                                                                                                  \
-    Eigen::Map<Eigen::Matrix<TYPE, Eigen::Dynamic, Eigen::Dynamic>> mat((TYPE *)data, dimensions.x(), dimensions.y()); \
-    mat.transposeInPlace();                                                                                            \
-    mat.colwise().reverseInPlace();
-
 void Image::rotate_counterclockwise()
 {
-    if (channels == 1)
-    {
-        ROT_CCW(uint8_t)
-    }
-    else if (channels == 2)
-    {
-        ROT_CCW(uint16_t)
-    }
-    else if (channels == 3)
-    {
-        ROT_CCW(Rgb)
-    }
-    else if (channels == 4)
-    {
-        ROT_CCW(Rgba)
-    }
-    dimensions = Eigen::Vector2i(dimensions.y(), dimensions.x());
+    Image rotated(dimensions.y(), dimensions.x(), channels);
+    imagekernels::rotate_counterclockwise(view(), rotated.view());
+    *this = std::move(rotated);
+}
+
+std::string Image::get_hash() const
+{
+    Md5Digest md5;
+    int32_t header[3] = {dimensions.x(), dimensions.y(), channels};
+    md5.update(header, sizeof(header));
+    md5.update(data, get_size());
+    return md5.hexdigest();
 }
 
 int Image::get_channels() const
@@ -226,7 +189,116 @@ Eigen::Vector2i Image::get_dimensions() const
     return dimensions;
 }
 
-void Image::save(const std::string &filename) const
+/**
+ * stb reads the png compression level from a global variable, so encodings with different levels must not overlap.
+ * encodings sharing the same level can still run in parallel.
+ */
+class PngLevelGuard
+{
+    static std::mutex mutex;
+    static std::condition_variable condition;
+    static int level;
+    static int users;
+
+public:
+    PngLevelGuard(int level_)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [&]()
+                       { return users == 0 || level == level_; });
+        level = level_;
+        stbi_write_png_compression_level = level_;
+        users++;
+    }
+
+    ~PngLevelGuard()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            users--;
+        }
+        condition.notify_all();
+    }
+};
+
+std::mutex PngLevelGuard::mutex;
+std::condition_variable PngLevelGuard::condition;
+int PngLevelGuard::level = 0;
+int PngLevelGuard::users = 0;
+
+static void append_to_vector(void *context, void *data, int size)
+{
+    auto *out = reinterpret_cast<std::vector<uint8_t> *>(context);
+    out->insert(out->end(), (uint8_t *)data, (uint8_t *)data + size);
+}
+
+Blob Image::encode(const std::string &format_, Compression compression) const
+{
+    std::string format = strutil::to_lower(format_);
+    std::vector<uint8_t> out;
+    int w = dimensions.x();
+    int h = dimensions.y();
+    int ok = 0;
+
+    if (format == "png")
+    {
+        PngLevelGuard guard(compression == Compression::Fast ? 1 : compression == Compression::Small ? 9 : 6);
+        ok = stbi_write_png_to_func(append_to_vector, &out, w, h, channels, data, w * channels);
+    }
+    else if (format == "jpg" || format == "jpeg")
+    {
+        // the quality does not change the encoding speed, Fast has nothing to trade and is the same as Default
+        int quality = compression == Compression::Small ? 75 : 90;
+        ok = stbi_write_jpg_to_func(append_to_vector, &out, w, h, channels, data, quality);
+    }
+    else if (format == "bmp")
+    {
+        ok = stbi_write_bmp_to_func(append_to_vector, &out, w, h, channels, data);
+    }
+    else if (format == "tga")
+    {
+        ok = stbi_write_tga_to_func(append_to_vector, &out, w, h, channels, data);
+    }
+    else if (format == "hdr")
+    {
+        // radiance is linear, the color channels are decoded from srgb, alpha is already linear
+        const float *to_linear = srgb::Tables::get().byte_to_linear;
+        int color_channels = channels == 2 || channels == 4 ? channels - 1 : channels;
+        std::vector<float> floats(get_size());
+        for (size_t i = 0; i < floats.size(); i++)
+        {
+            floats[i] = int(i % channels) < color_channels ? to_linear[data[i]] : data[i] / 255.0f;
+        }
+        ok = stbi_write_hdr_to_func(append_to_vector, &out, w, h, channels, floats.data());
+    }
+    else
+    {
+        throw std::runtime_error("unsupported image format '" + format_ + "'");
+    }
+
+    if (!ok)
+    {
+        throw std::runtime_error("failed to encode image as " + format);
+    }
+    Blob blob(out.size());
+    memcpy(blob.get_ptr(), out.data(), out.size());
+    return blob;
+}
+
+void Image::save(const std::string &filename, Compression compression) const
+{
+    Blob encoded = encode(FileSystem::get_extension(filename), compression);
+    FileSystem::get_entry(filename)->write(encoded);
+}
+
+std::future<void> Image::save_async(const std::string &filename, Compression compression) const
+{
+    return save_async(copy(), filename, compression);
+}
+
+std::future<void> Image::save_async(Image &&image, const std::string &filename, Compression compression)
 {
-    // TODO
+    auto shared = std::make_shared<Image>(std::move(image));
+    return ThreadPool::get_default().submit([shared, filename, compression]()
+                                            { shared->save(filename, compression); });
 }
\ No newline at end of file
@@ -0,0 +1,419 @@
+#include "ImageKernels.hpp"
+#include "Srgb.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ZENGINE_SSE2
+#endif
+
+namespace imagekernels
+{
+    static constexpr int TILE = 16;
+
+    template <int N>
+    static void transpose_tile(const ConstImageView &src, const ImageView &dst, int x0, int y0, int width, int height)
+    {
+        for (int x = x0; x < x0 + width; x++)
+        {
+            uint8_t *out = dst.get_pixel(y0, x);
+            for (int y = y0; y < y0 + height; y++, out += N)
+            {
+                memcpy(out, src.get_pixel(x, y), N);
+            }
+        }
+    }
+
+#ifdef ZENGINE_SSE2
+    // 8x8 bytes, rows loaded as 64 bits words and interleaved 3 times
+    static void transpose_8x8_u8(const uint8_t *src, size_t src_stride, uint8_t *dst, size_t dst_stride)
+    {
+        __m128i r[8];
+        for (int i = 0; i < 8; i++)
+        {
+            r[i] = _mm_loadl_epi64((const __m128i *)(src + i * src_stride));
+        }
+        __m128i a = _mm_unpacklo_epi8(r[0], r[1]);
+        __m128i b = _mm_unpacklo_epi8(r[2], r[3]);
+        __m128i c = _mm_unpacklo_epi8(r[4], r[5]);
+        __m128i d = _mm_unpacklo_epi8(r[6], r[7]);
+        __m128i e = _mm_unpacklo_epi16(a, b);
+        __m128i f = _mm_unpackhi_epi16(a, b);
+        __m128i g = _mm_unpacklo_epi16(c, d);
+        __m128i h = _mm_unpackhi_epi16(c, d);
+        __m128i columns[4] = {_mm_unpacklo_epi32(e, g), _mm_unpackhi_epi32(e, g), _mm_unpacklo_epi32(f, h), _mm_unpackhi_epi32(f, h)};
+        for (int i = 0; i < 4; i++)
+        {
+            _mm_storel_epi64((__m128i *)(dst + (2 * i) * dst_stride), columns[i]);
+            _mm_storel_epi64((__m128i *)(dst + (2 * i + 1) * dst_stride), _mm_unpackhi_epi64(columns[i], columns[i]));
+        }
+    }
+
+    // 4x4 pixels of 32 bits
+    static void transpose_4x4_u32(const uint8_t *src, size_t src_stride, uint8_t *dst, size_t dst_stride)
+    {
+        __m128i r0 = _mm_loadu_si128((const __m128i *)(src));
+        __m128i r1 = _mm_loadu_si128((const __m128i *)(src + src_stride));
+        __m128i r2 = _mm_loadu_si128((const __m128i *)(src + 2 * src_stride));
+        __m128i r3 = _mm_loadu_si128((const __m128i *)(src + 3 * src_stride));
+        __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+        __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+        __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+        __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+        _mm_storeu_si128((__m128i *)(dst), _mm_unpacklo_epi64(t0, t1));
+        _mm_storeu_si128((__m128i *)(dst + dst_stride), _mm_unpackhi_epi64(t0, t1));
+        _mm_storeu_si128((__m128i *)(dst + 2 * dst_stride), _mm_unpacklo_epi64(t2, t3));
+        _mm_storeu_si128((__m128i *)(dst + 3 * dst_stride), _mm_unpackhi_epi64(t2, t3));
+    }
+
+    template <>
+    void transpose_tile<1>(const ConstImageView &src, const ImageView &dst, int x0, int y0, int width, int height)
+    {
+        if (width != TILE || height != TILE)
+        {
+            for (int x = x0; x < x0 + width; x++)
+            {
+                uint8_t *out = dst.get_pixel(y0, x);
+                for (int y = y0; y < y0 + height; y++)
+                {
+                    *out++ = *src.get_pixel(x, y);
+                }
+            }
+            return;
+        }
+        for (int y = y0; y < y0 + TILE; y += 8)
+        {
+            for (int x = x0; x < x0 + TILE; x += 8)
+            {
+                transpose_8x8_u8(src.get_pixel(x, y), src.get_stride(), dst.get_pixel(y, x), dst.get_stride());
+            }
+        }
+    }
+
+    template <>
+    void transpose_tile<4>(const ConstImageView &src, const ImageView &dst, int x0, int y0, int width, int height)
+    {
+        if (width != TILE || height != TILE)
+        {
+            for (int x = x0; x < x0 + width; x++)
+            {
+                uint8_t *out = dst.get_pixel(y0, x);
+                for (int y = y0; y < y0 + height; y++, out += 4)
+                {
+                    memcpy(out, src.get_pixel(x, y), 4);
+                }
+            }
+            return;
+        }
+        for (int y = y0; y < y0 + TILE; y += 4)
+        {
+            for (int x = x0; x < x0 + TILE; x += 4)
+            {
+                transpose_4x4_u32(src.get_pixel(x, y), src.get_stride(), dst.get_pixel(y, x), dst.get_stride());
+            }
+        }
+    }
+#endif
+
+    template <int N>
+    static void transpose_tiled(const ConstImageView &src, const ImageView &dst)
+    {
+        int width = src.get_width();
+        int height = src.get_height();
+        int tile_rows = (height + TILE - 1) / TILE;
+#pragma omp parallel for schedule(dynamic) if (size_t(width) * height > (1 << 20))
+        for (int row = 0; row < tile_rows; row++)
+        {
+            int y0 = row * TILE;
+            int tile_height = std::min(TILE, height - y0);
+            for (int x0 = 0; x0 < width; x0 += TILE)
+            {
+                transpose_tile<N>(src, dst, x0, y0, std::min(TILE, width - x0), tile_height);
+            }
+        }
+    }
+
+    static void check_transposed(const ConstImageView &src, const ImageView &dst)
+    {
+        if (dst.get_width() != src.get_height() || dst.get_height() != src.get_width() || dst.get_channels() != src.get_channels())
+        {
+            throw std::invalid_argument("destination must have the transposed dimensions of the source");
+        }
+    }
+
+    void transpose(const ConstImageView &src, const ImageView &dst)
+    {
+        check_transposed(src, dst);
+        switch (src.get_channels())
+        {
+        case 1:
+            transpose_tiled<1>(src, dst);
+            break;
+        case 2:
+            transpose_tiled<2>(src, dst);
+            break;
+        case 3:
+            transpose_tiled<3>(src, dst);
+            break;
+        case 4:
+            transpose_tiled<4>(src, dst);
+            break;
+        default:
+            throw std::invalid_argument("invalid number of channels");
+        }
+    }
+
+    void transpose_in_place(uint8_t *data, int width, int height, int channels)
+    {
+        size_t count = size_t(width) * height;
+        if (count < 2)
+        {
+            return;
+        }
+        if (width == height)
+        {
+            // square : swap the pixels across the diagonal
+            for (int y = 0; y < height; y++)
+            {
+                for (int x = y + 1; x < width; x++)
+                {
+                    std::swap_ranges(data + (size_t(y) * width + x) * channels, data + (size_t(y) * width + x + 1) * channels, data + (size_t(x) * width + y) * channels);
+                }
+            }
+            return;
+        }
+
+        // the pixel at index k = y * width + x goes to x * height + y = (k * height) mod (count - 1)
+        // each permutation cycle is followed once, the first and last pixels never move
+        std::vector<bool> visited(count, false);
+        uint8_t carried[4], next[4];
+        for (size_t start = 1; start < count - 1; start++)
+        {
+            if (visited[start])
+            {
+                continue;
+            }
+            memcpy(carried, data + start * channels, channels);
+            size_t k = start;
+            do
+            {
+                size_t target = (k * height) % (count - 1);
+                memcpy(next, data + target * channels, channels);
+                memcpy(data + target * channels, carried, channels);
+                memcpy(carried, next, channels);
+                visited[target] = true;
+                k = target;
+            } while (k != start);
+        }
+    }
+
+    template <int N>
+    static void reverse_row(uint8_t *row, int width)
+    {
+        uint8_t tmp[N];
+        for (int left = 0, right = width - 1; left < right; left++, right--)
+        {
+            memcpy(tmp, row + left * N, N);
+            memcpy(row + left * N, row + right * N, N);
+            memcpy(row + right * N, tmp, N);
+        }
+    }
+
+    void flip_horizontally(const ImageView &view)
+    {
+        for (int y = 0; y < view.get_height(); y++)
+        {
+            switch (view.get_channels())
+            {
+            case 1:
+                std::reverse(view.get_row(y), view.get_row(y) + view.get_width());
+                break;
+            case 2:
+                reverse_row<2>(view.get_row(y), view.get_width());
+                break;
+            case 3:
+                reverse_row<3>(view.get_row(y), view.get_width());
+                break;
+            case 4:
+                reverse_row<4>(view.get_row(y), view.get_width());
+                break;
+            default:
+                throw std::invalid_argument("invalid number of channels");
+            }
+        }
+    }
+
+    void flip_vertically(const ImageView &view)
+    {
+        size_t row_size = view.get_row_size();
+        for (int top = 0, bottom = view.get_height() - 1; top < bottom; top++, bottom--)
+        {
+            std::swap_ranges(view.get_row(top), view.get_row(top) + row_size, view.get_row(bottom));
+        }
+    }
+
+    void rotate_clockwise(const ConstImageView &src, const ImageView &dst)
+    {
+        // dst(x, y) = src(y, h - 1 - x) : a transposition followed by a mirror of the rows
+        transpose(src, dst);
+        flip_horizontally(dst);
+    }
+
+    void rotate_counterclockwise(const ConstImageView &src, const ImageView &dst)
+    {
+        // dst(x, y) = src(w - 1 - y, x) : a transposition followed by a mirror of the row order
+        transpose(src, dst);
+        flip_vertically(dst);
+    }
+
+    /**
+     * lookup tables between bytes and floats in [0, 1], per channel kind
+     */
+    struct Decoding
+    {
+        float to_float[2][256];       // [linear, srgb]
+        uint8_t to_byte[2][4096 + 1]; // indexed by value * 4096
+
+        Decoding()
+        {
+            const srgb::Tables &tables = srgb::Tables::get();
+            static_assert(srgb::Tables::STEPS == 4096, "the byte table is sampled like the srgb tables");
+            for (int i = 0; i < 256; i++)
+            {
+                to_float[0][i] = i / 255.0f;
+                to_float[1][i] = tables.byte_to_linear[i];
+            }
+            for (int i = 0; i <= 4096; i++)
+            {
+                to_byte[0][i] = uint8_t(std::lround(i * 255.0f / 4096.0f));
+                to_byte[1][i] = uint8_t(std::lround(tables.to_srgb[i] * 255.0f));
+            }
+        }
+
+        static const Decoding &get()
+        {
+            static Decoding decoding;
+            return decoding;
+        }
+    };
+
+    /**
+     * for each output position, the range of input positions and their weights
+     */
+    struct Contributions
+    {
+        int taps = 0;               // weights per output position
+        std::vector<int> first;     // first input position
+        std::vector<float> weights; // taps per output position, zero padded
+
+        Contributions(int in, int out)
+        {
+            float scale = float(in) / out;
+            float support = std::max(1.0f, scale);
+            taps = int(std::ceil(support)) * 2 + 1;
+            first.resize(out);
+            weights.assign(size_t(out) * taps, 0.0f);
+            for (int o = 0; o < out; o++)
+            {
+                float center = (o + 0.5f) * scale - 0.5f;
+                int start = int(std::floor(center - support)) + 1;
+                first[o] = std::clamp(start, 0, in - 1);
+                float *w = &weights[size_t(o) * taps];
+                float total = 0.0f;
+                for (int k = 0; k < taps; k++)
+                {
+                    float weight = std::max(0.0f, 1.0f - std::abs(start + k - center) / support);
+                    // positions outside of the image are clamped to the edge
+                    int i = std::clamp(start + k, 0, in - 1) - first[o];
+                    if (i >= taps)
+                    {
+                        i = taps - 1;
+                    }
+                    w[i] += weight;
+                    total += weight;
+                }
+                for (int k = 0; k < taps; k++)
+                {
+                    w[k] /= total;
+                }
+            }
+        }
+    };
+
+    void resample(const ConstImageView &src, const ImageView &dst, bool srgb)
+    {
+        int channels = src.get_channels();
+        if (dst.get_channels() != channels)
+        {
+            throw std::invalid_argument("source and destination must have the same channels");
+        }
+        int src_width = src.get_width(), src_height = src.get_height();
+        int dst_width = dst.get_width(), dst_height = dst.get_height();
+        if (src_width == 0 || src_height == 0 || dst_width == 0 || dst_height == 0)
+        {
+            return;
+        }
+
+        // gray + alpha and rgba keep a linear alpha
+        int kind[4];
+        for (int c = 0; c < channels; c++)
+        {
+            bool alpha = (channels == 2 || channels == 4) && c == channels - 1;
+            kind[c] = srgb && !alpha ? 1 : 0;
+        }
+        const Decoding &decoding = Decoding::get();
+        Contributions horizontal(src_width, dst_width);
+        Contributions vertical(src_height, dst_height);
+
+        // horizontal pass, every source row is resampled to the destination width
+        size_t row_floats = size_t(dst_width) * channels;
+        std::vector<float> rows(row_floats * src_height);
+#pragma omp parallel for if (size_t(src_height) * dst_width > (1 << 16))
+        for (int y = 0; y < src_height; y++)
+        {
+            const uint8_t *in = src.get_row(y);
+            float *out = &rows[row_floats * y];
+            for (int x = 0; x < dst_width; x++)
+            {
+                const float *w = &horizontal.weights[size_t(x) * horizontal.taps];
+                const uint8_t *pixel = in + size_t(horizontal.first[x]) * channels;
+                int taps = std::min(horizontal.taps, src_width - horizontal.first[x]);
+                for (int c = 0; c < channels; c++)
+                {
+                    const float *to_float = decoding.to_float[kind[c]];
+                    float sum = 0.0f;
+                    for (int k = 0; k < taps; k++)
+                    {
+                        sum += w[k] * to_float[pixel[k * channels + c]];
+                    }
+                    out[x * channels + c] = sum;
+                }
+            }
+        }
+
+        // vertical pass, split by destination rows
+#pragma omp parallel for if (size_t(dst_height) * dst_width > (1 << 16))
+        for (int y = 0; y < dst_height; y++)
+        {
+            const float *w = &vertical.weights[size_t(y) * vertical.taps];
+            int first = vertical.first[y];
+            int taps = std::min(vertical.taps, src_height - first);
+            uint8_t *out = dst.get_row(y);
+            for (size_t i = 0; i < row_floats; i++)
+            {
+                float sum = 0.0f;
+                for (int k = 0; k < taps; k++)
+                {
+                    sum += w[k] * rows[row_floats * (first + k) + i];
+                }
+                int index = int(std::clamp(sum, 0.0f, 1.0f) * 4096.0f + 0.5f);
+                out[i] = decoding.to_byte[kind[i % channels]][index];
+            }
+        }
+    }
+}
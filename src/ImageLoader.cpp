@@ -0,0 +1,139 @@
+#include "ImageLoader.hpp"
+#include "FileSystem.hpp"
+
+#include <stdexcept>
+
+ImageLoader::Ticket::Ticket(std::shared_ptr<Pending> pending_) : pending(pending_)
+{
+}
+
+bool ImageLoader::Ticket::is_ready() const
+{
+    return pending && pending->future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+Image ImageLoader::Ticket::get()
+{
+    if (!pending)
+    {
+        throw std::runtime_error("empty image ticket");
+    }
+    return pending->future.get();
+}
+
+void ImageLoader::Ticket::cancel()
+{
+    if (pending)
+    {
+        pending->cancelled = true;
+    }
+}
+
+bool ImageLoader::Ticket::is_valid() const
+{
+    return pending != nullptr;
+}
+
+ImageLoader::ImageLoader(size_t count)
+{
+    if (count == 0)
+    {
+        count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        workers.emplace_back(&ImageLoader::work, this);
+    }
+}
+
+ImageLoader::~ImageLoader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        while (!queue.empty())
+        {
+            if (auto pending = queue.top().pending.lock())
+            {
+                pending->promise.set_exception(std::make_exception_ptr(std::runtime_error("image loader stopped before loading " + pending->uri)));
+            }
+            queue.pop();
+        }
+    }
+    condition.notify_all();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+ImageLoader &ImageLoader::get_default()
+{
+    static ImageLoader loader;
+    return loader;
+}
+
+ImageLoader::Ticket ImageLoader::load(const std::string &uri, int priority, std::function<void(const Image &)> on_loaded)
+{
+    auto pending = std::make_shared<Pending>();
+    pending->uri = uri;
+    pending->future = pending->promise.get_future();
+    pending->on_loaded = on_loaded;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping)
+        {
+            throw std::runtime_error("image loader is stopping");
+        }
+        queue.push(Queued{priority, sequence++, pending});
+    }
+    condition.notify_one();
+    return Ticket(pending);
+}
+
+size_t ImageLoader::get_queue_size()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size();
+}
+
+void ImageLoader::work()
+{
+    while (true)
+    {
+        std::shared_ptr<Pending> pending;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]()
+                           { return stopping || !queue.empty(); });
+            if (stopping)
+            {
+                return;
+            }
+            pending = queue.top().pending.lock();
+            queue.pop();
+        }
+        if (!pending)
+        {
+            continue; // nobody holds the ticket anymore
+        }
+        if (pending->cancelled)
+        {
+            pending->promise.set_exception(std::make_exception_ptr(std::runtime_error("cancelled loading of " + pending->uri)));
+            continue;
+        }
+        try
+        {
+            Image image = Image::load(FileSystem::get_entry(pending->uri)->read());
+            if (pending->on_loaded)
+            {
+                pending->on_loaded(image);
+            }
+            pending->promise.set_value(std::move(image));
+        }
+        catch (...)
+        {
+            pending->promise.set_exception(std::current_exception());
+        }
+    }
+}
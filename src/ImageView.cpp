@@ -0,0 +1,102 @@
+#include "ImageView.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+template <typename Byte>
+BasicImageView<Byte>::BasicImageView(Void *data_, int width_, int height_, int channels_, size_t stride_)
+    : data((Byte *)data_), width(width_), height(height_), channels(channels_), stride(stride_ == 0 ? size_t(width_) * channels_ : stride_)
+{
+    if (stride < get_row_size())
+    {
+        throw std::invalid_argument("image stride is smaller than a row");
+    }
+}
+
+template <typename Byte>
+BasicImageView<Byte> BasicImageView<Byte>::sub(int x, int y, int width_, int height_) const
+{
+    if (x < 0 || y < 0 || width_ < 0 || height_ < 0 || x + width_ > width || y + height_ > height)
+    {
+        throw std::out_of_range("sub view exceeds the image bounds");
+    }
+    BasicImageView view;
+    view.data = get_pixel(x, y);
+    view.width = width_;
+    view.height = height_;
+    view.channels = channels;
+    view.stride = stride;
+    return view;
+}
+
+template <typename Byte>
+void BasicImageView<Byte>::copy_to(void *destination) const
+{
+    if (is_contiguous())
+    {
+        memcpy(destination, data, get_size());
+        return;
+    }
+    size_t row_size = get_row_size();
+    for (int y = 0; y < height; y++)
+    {
+        memcpy((uint8_t *)destination + y * row_size, get_row(y), row_size);
+    }
+}
+
+template <typename Byte>
+typename BasicImageView<Byte>::Void *BasicImageView<Byte>::get_data() const
+{
+    return data;
+}
+
+template <typename Byte>
+int BasicImageView<Byte>::get_width() const
+{
+    return width;
+}
+
+template <typename Byte>
+int BasicImageView<Byte>::get_height() const
+{
+    return height;
+}
+
+template <typename Byte>
+Eigen::Vector2i BasicImageView<Byte>::get_dimensions() const
+{
+    return Eigen::Vector2i(width, height);
+}
+
+template <typename Byte>
+int BasicImageView<Byte>::get_channels() const
+{
+    return channels;
+}
+
+template <typename Byte>
+size_t BasicImageView<Byte>::get_stride() const
+{
+    return stride;
+}
+
+template <typename Byte>
+size_t BasicImageView<Byte>::get_row_size() const
+{
+    return size_t(width) * channels;
+}
+
+template <typename Byte>
+size_t BasicImageView<Byte>::get_size() const
+{
+    return get_row_size() * height;
+}
+
+template <typename Byte>
+bool BasicImageView<Byte>::is_contiguous() const
+{
+    return stride == get_row_size() || height <= 1;
+}
+
+template class BasicImageView<uint8_t>;
+template class BasicImageView<const uint8_t>;
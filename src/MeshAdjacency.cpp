@@ -0,0 +1,156 @@
+#include "MeshAdjacency.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+static inline uint64_t edge_key(uint32_t from, uint32_t to)
+{
+    return (uint64_t(from) << 32) | to;
+}
+
+MeshAdjacency::MeshAdjacency(const std::vector<uint32_t> &indices, size_t vertex_count) : origins(indices)
+{
+    if (indices.size() % 3 != 0)
+    {
+        throw std::invalid_argument("the index count is not a multiple of 3 : " + std::to_string(indices.size()));
+    }
+    for (uint32_t index : indices)
+    {
+        if (index >= vertex_count)
+        {
+            throw std::out_of_range("vertex index " + std::to_string(index) + " out of range, the mesh has " + std::to_string(vertex_count) + " vertices");
+        }
+    }
+    size_t halfedge_count = origins.size();
+    twins.assign(halfedge_count, INVALID);
+
+    // pair the half-edges : each directed edge a->b waits in the map until its opposite b->a shows up
+    std::unordered_map<uint64_t, uint32_t> open_edges;
+    open_edges.reserve(halfedge_count);
+    for (uint32_t h = 0; h < halfedge_count; h++)
+    {
+        uint32_t a = from(h);
+        uint32_t b = to(h);
+        auto it = open_edges.find(edge_key(b, a));
+        if (it != open_edges.end())
+        {
+            twins[h] = it->second;
+            twins[it->second] = h;
+            open_edges.erase(it);
+        }
+        else if (!open_edges.emplace(edge_key(a, b), h).second)
+        {
+            // the same directed edge used twice : either a third triangle on the edge or a flipped triangle
+            non_manifold_edges++;
+        }
+    }
+
+    // outgoing half-edges, grouped by origin (counting sort)
+    outgoing_offsets.assign(vertex_count + 1, 0);
+    for (uint32_t h = 0; h < halfedge_count; h++)
+    {
+        outgoing_offsets[origins[h] + 1]++;
+    }
+    for (size_t v = 0; v < vertex_count; v++)
+    {
+        outgoing_offsets[v + 1] += outgoing_offsets[v];
+    }
+    outgoing_halfedges.resize(halfedge_count);
+    std::vector<uint32_t> cursor(outgoing_offsets.begin(), outgoing_offsets.end() - 1);
+    for (uint32_t h = 0; h < halfedge_count; h++)
+    {
+        outgoing_halfedges[cursor[origins[h]]++] = h;
+    }
+
+    // one-ring : targets of the outgoing half-edges, plus the origins of the incoming boundary half-edges
+    // (on a boundary the last neighbour of the fan is only reachable through an incoming edge)
+    neighbour_offsets.assign(vertex_count + 1, 0);
+    for (uint32_t h = 0; h < halfedge_count; h++)
+    {
+        neighbour_offsets[from(h) + 1]++;
+        if (twins[h] == INVALID)
+        {
+            neighbour_offsets[to(h) + 1]++;
+        }
+    }
+    for (size_t v = 0; v < vertex_count; v++)
+    {
+        neighbour_offsets[v + 1] += neighbour_offsets[v];
+    }
+    neighbour_vertices.resize(neighbour_offsets.back());
+    cursor.assign(neighbour_offsets.begin(), neighbour_offsets.end() - 1);
+    for (uint32_t h = 0; h < halfedge_count; h++)
+    {
+        neighbour_vertices[cursor[from(h)]++] = to(h);
+        if (twins[h] == INVALID)
+        {
+            neighbour_vertices[cursor[to(h)]++] = from(h);
+        }
+    }
+
+    // remove duplicates (boundary and non-manifold fans) and compact the arrays in place
+    uint32_t write = 0;
+    for (size_t v = 0; v < vertex_count; v++)
+    {
+        auto begin = neighbour_vertices.begin() + neighbour_offsets[v];
+        auto end = neighbour_vertices.begin() + neighbour_offsets[v + 1];
+        std::sort(begin, end);
+        end = std::unique(begin, end);
+        neighbour_offsets[v] = write;
+        for (auto it = begin; it != end; ++it)
+        {
+            neighbour_vertices[write++] = *it;
+        }
+    }
+    neighbour_offsets[vertex_count] = write;
+    neighbour_vertices.resize(write);
+    neighbour_vertices.shrink_to_fit();
+}
+
+bool MeshAdjacency::is_boundary_vertex(uint32_t v) const
+{
+    for (uint32_t h : outgoing(v))
+    {
+        if (is_boundary(h) || is_boundary(prev(h)))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::span<const uint32_t> MeshAdjacency::outgoing(uint32_t v) const
+{
+    return std::span<const uint32_t>(outgoing_halfedges.data() + outgoing_offsets[v], outgoing_offsets[v + 1] - outgoing_offsets[v]);
+}
+
+std::span<const uint32_t> MeshAdjacency::neighbours(uint32_t v) const
+{
+    return std::span<const uint32_t>(neighbour_vertices.data() + neighbour_offsets[v], neighbour_offsets[v + 1] - neighbour_offsets[v]);
+}
+
+std::array<uint32_t, 3> MeshAdjacency::face_neighbours(uint32_t f) const
+{
+    std::array<uint32_t, 3> result;
+    for (uint32_t k = 0; k < 3; k++)
+    {
+        uint32_t t = twins[3 * f + k];
+        result[k] = t == INVALID ? INVALID : face(t);
+    }
+    return result;
+}
+
+std::vector<uint32_t> MeshAdjacency::boundary_halfedges() const
+{
+    std::vector<uint32_t> result;
+    for (uint32_t h = 0; h < twins.size(); h++)
+    {
+        if (twins[h] == INVALID)
+        {
+            result.push_back(h);
+        }
+    }
+    return result;
+}
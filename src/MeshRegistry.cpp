@@ -0,0 +1,129 @@
+#include "MeshRegistry.hpp"
+#include "VertexArray.hpp"
+
+MeshRegistry &MeshRegistry::get_instance()
+{
+    static MeshRegistry instance;
+    return instance;
+}
+
+std::shared_ptr<const MeshRegistry::Mesh> MeshRegistry::add(Geometry geometry)
+{
+    std::string hash = geometry.get_hash();
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    Entry &entry = entries[hash];
+    if (auto mesh = entry.mesh.lock())
+    {
+        return mesh;
+    }
+    auto mesh = std::make_shared<const Mesh>(Mesh{hash, std::move(geometry)});
+    entry.mesh = mesh;
+    return mesh;
+}
+
+std::shared_ptr<const MeshRegistry::Mesh> MeshRegistry::get_or_create(const std::string &name, std::function<Geometry()> factory)
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    auto it = names.find(name);
+    if (it != names.end())
+    {
+        auto entry = entries.find(it->second);
+        if (entry != entries.end())
+        {
+            if (auto mesh = entry->second.mesh.lock())
+            {
+                return mesh;
+            }
+        }
+    }
+    auto mesh = add(factory());
+    names[name] = mesh->hash;
+    return mesh;
+}
+
+std::shared_ptr<VertexBuffer> MeshRegistry::get_buffer(const Mesh &mesh, std::weak_ptr<VertexBuffer> Entry::*buffer, std::function<std::shared_ptr<VertexBuffer>()> create)
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    Entry &entry = entries[mesh.hash];
+    if (auto existing = (entry.*buffer).lock())
+    {
+        return existing;
+    }
+    auto created = create();
+    entry.*buffer = created;
+    return created;
+}
+
+std::shared_ptr<VertexBuffer> MeshRegistry::get_vertex_buffer(const Mesh &mesh)
+{
+    return get_buffer(mesh, &Entry::vertices, [&mesh]()
+                      { return std::make_shared<VertexBuffer>(mesh.geometry.vertices); });
+}
+
+std::shared_ptr<VertexBuffer> MeshRegistry::get_normal_buffer(const Mesh &mesh)
+{
+    return get_buffer(mesh, &Entry::normals, [&mesh]()
+                      {
+        if(mesh.geometry.normals.size() == mesh.geometry.vertices.size()) {
+            return std::make_shared<VertexBuffer>(mesh.geometry.normals);
+        }
+        Geometry copy = mesh.geometry.copy();
+        copy.recompute_normals();
+        return std::make_shared<VertexBuffer>(copy.normals); });
+}
+
+std::shared_ptr<VertexBuffer> MeshRegistry::get_index_buffer(const Mesh &mesh)
+{
+    return get_buffer(mesh, &Entry::indices, [&mesh]()
+                      { return std::make_shared<VertexBuffer>(mesh.geometry.indices); });
+}
+
+void MeshRegistry::bind(VertexArray &vao, const Mesh &mesh, int position_location, int normal_location)
+{
+    if (position_location >= 0)
+    {
+        vao.bind_buffer(position_location, "v3", get_vertex_buffer(mesh));
+    }
+    if (normal_location >= 0)
+    {
+        vao.bind_buffer(normal_location, "v3", get_normal_buffer(mesh));
+    }
+    if (!mesh.geometry.indices.empty())
+    {
+        vao.set_ebo(get_index_buffer(mesh));
+    }
+}
+
+void MeshRegistry::purge()
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        const Entry &entry = it->second;
+        if (entry.mesh.expired() && entry.vertices.expired() && entry.normals.expired() && entry.indices.expired())
+        {
+            it = entries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    for (auto it = names.begin(); it != names.end();)
+    {
+        if (entries.find(it->second) == entries.end())
+        {
+            it = names.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+size_t MeshRegistry::get_size()
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    return entries.size();
+}
@@ -0,0 +1,465 @@
+#include "MeshStream.hpp"
+#include "FileSystem.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+static const char MAGIC[4] = {'Z', 'M', 'S', 'H'};
+static const uint32_t VERSION = 1;
+static const uint32_t FLAG_NORMALS = 1;
+
+/**
+ * a growable array of vectors kept in a temporary file, with a LRU cache of pages in memory
+ */
+class PagedVectorStore
+{
+    static constexpr size_t PAGE_SIZE = 1024; // in elements
+    static constexpr size_t NO_PAGE = std::numeric_limits<size_t>::max();
+
+    struct Page
+    {
+        size_t number = NO_PAGE;
+        std::vector<Eigen::Vector3f> data;
+        bool dirty = false;
+        uint64_t last_use = 0;
+    };
+
+    FILE *file;
+    std::vector<Page> pages;
+    std::unordered_map<size_t, size_t> slots; // page number -> index in pages
+    uint64_t clock = 0;
+
+    static void seek(FILE *file, size_t page_number)
+    {
+        int64_t offset = int64_t(page_number) * PAGE_SIZE * sizeof(Eigen::Vector3f);
+#ifdef _WIN32
+        int ret = _fseeki64(file, offset, SEEK_SET);
+#else
+        int ret = fseeko(file, offset, SEEK_SET);
+#endif
+        if (ret != 0)
+        {
+            throw std::runtime_error("seek failed in temporary file");
+        }
+    }
+
+    Page &get_page(size_t number)
+    {
+        auto it = slots.find(number);
+        if (it != slots.end())
+        {
+            Page &page = pages[it->second];
+            page.last_use = ++clock;
+            return page;
+        }
+
+        // evict the least recently used page
+        size_t victim = 0;
+        for (size_t i = 1; i < pages.size(); i++)
+        {
+            if (pages[i].last_use < pages[victim].last_use)
+            {
+                victim = i;
+            }
+        }
+        Page &page = pages[victim];
+        if (page.number != NO_PAGE)
+        {
+            if (page.dirty)
+            {
+                seek(file, page.number);
+                if (fwrite(page.data.data(), sizeof(Eigen::Vector3f), PAGE_SIZE, file) != PAGE_SIZE)
+                {
+                    throw std::runtime_error("could not write a page to the temporary file (disk full ?)");
+                }
+            }
+            slots.erase(page.number);
+        }
+
+        // load the new one, pages that were never written read as zeros
+        page.number = number;
+        page.dirty = false;
+        page.last_use = ++clock;
+        page.data.assign(PAGE_SIZE, Eigen::Vector3f::Zero());
+        seek(file, number);
+        size_t read = fread(page.data.data(), sizeof(Eigen::Vector3f), PAGE_SIZE, file);
+        (void)read;
+        clearerr(file);
+        slots[number] = victim;
+        return page;
+    }
+
+public:
+    PagedVectorStore(size_t cache_bytes)
+    {
+        file = std::tmpfile();
+        if (!file)
+        {
+            throw std::runtime_error("could not create a temporary file");
+        }
+        pages.resize(std::max<size_t>(2, cache_bytes / (PAGE_SIZE * sizeof(Eigen::Vector3f))));
+    }
+
+    ~PagedVectorStore()
+    {
+        fclose(file);
+    }
+
+    Eigen::Vector3f get(size_t i)
+    {
+        return get_page(i / PAGE_SIZE).data[i % PAGE_SIZE];
+    }
+
+    void set(size_t i, const Eigen::Vector3f &value)
+    {
+        Page &page = get_page(i / PAGE_SIZE);
+        page.data[i % PAGE_SIZE] = value;
+        page.dirty = true;
+    }
+
+    void add(size_t i, const Eigen::Vector3f &value)
+    {
+        Page &page = get_page(i / PAGE_SIZE);
+        page.data[i % PAGE_SIZE] += value;
+        page.dirty = true;
+    }
+};
+
+/**
+ * reads the vertices and triangles of an obj file line by line
+ */
+class ObjReader
+{
+    std::unique_ptr<std::istream> in;
+    std::string line;
+    std::vector<uint32_t> polygon;
+    size_t fan = 0;           // next triangle of the current polygon
+    size_t total_vertices;    // used to check the indices, known after the first pass
+    size_t vertices_seen = 0; // needed for negative (relative) indices
+
+    bool next_line()
+    {
+        while (std::getline(*in, line))
+        {
+            if (line.size() > 2 && (line[0] == 'v' || line[0] == 'f') && (line[1] == ' ' || line[1] == '\t'))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    ObjReader(const std::string &uri, size_t total_vertices_ = std::numeric_limits<size_t>::max()) : in(FileSystem::get_entry(uri)->open()), total_vertices(total_vertices_)
+    {
+    }
+
+    bool next_vertex(Eigen::Vector3f &vertex)
+    {
+        while (next_line())
+        {
+            if (line[0] == 'v')
+            {
+                char *end;
+                vertex.x() = strtof(line.c_str() + 2, &end);
+                vertex.y() = strtof(end, &end);
+                vertex.z() = strtof(end, &end);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool next_triangle(uint32_t &a, uint32_t &b, uint32_t &c)
+    {
+        while (fan + 2 >= polygon.size())
+        {
+            if (!next_line())
+            {
+                return false;
+            }
+            if (line[0] == 'v')
+            {
+                vertices_seen++;
+                continue;
+            }
+            polygon.clear();
+            fan = 0;
+            const char *p = line.c_str() + 2;
+            while (*p)
+            {
+                char *end;
+                long index = strtol(p, &end, 10);
+                if (end == p)
+                {
+                    break;
+                }
+                index = index < 0 ? long(vertices_seen) + index : index - 1;
+                if (index < 0 || size_t(index) >= total_vertices)
+                {
+                    throw std::runtime_error("invalid vertex index in obj face : " + line);
+                }
+                polygon.push_back(uint32_t(index));
+                // skip texture and normal indices
+                p = end;
+                while (*p && *p != ' ' && *p != '\t')
+                {
+                    p++;
+                }
+                while (*p == ' ' || *p == '\t' || *p == '\r')
+                {
+                    p++;
+                }
+            }
+        }
+        a = polygon[0];
+        b = polygon[fan + 1];
+        c = polygon[fan + 2];
+        fan++;
+        return true;
+    }
+};
+
+/**
+ * serializes batches, one at a time
+ */
+struct BatchWriter
+{
+    std::string buffer;
+
+    template <typename T>
+    void put(const T *data, size_t count)
+    {
+        buffer.append(reinterpret_cast<const char *>(data), count * sizeof(T));
+    }
+
+    void header(uint32_t flags)
+    {
+        buffer.clear();
+        put(MAGIC, 4);
+        put(&VERSION, 1);
+        put(&flags, 1);
+    }
+
+    void batch(const std::vector<Eigen::Vector3f> &positions, const std::vector<Eigen::Vector3f> &normals, const std::vector<uint32_t> &indices)
+    {
+        buffer.clear();
+        uint32_t vertex_count = positions.size();
+        uint32_t index_count = indices.size();
+        put(&vertex_count, 1);
+        put(&index_count, 1);
+        put(positions.data(), positions.size());
+        put(normals.data(), normals.size());
+        put(indices.data(), indices.size());
+    }
+
+    std::pair<const void *, size_t> get() const
+    {
+        return {buffer.data(), buffer.size()};
+    }
+};
+
+MeshStream::MeshStream(const std::string &uri_) : uri(uri_)
+{
+}
+
+void MeshStream::for_each_batch(std::function<bool(const Geometry &)> callback) const
+{
+    auto in = FileSystem::get_entry(uri)->open();
+    char magic[4];
+    uint32_t version, flags;
+    in->read(magic, 4);
+    in->read(reinterpret_cast<char *>(&version), sizeof(version));
+    in->read(reinterpret_cast<char *>(&flags), sizeof(flags));
+    if (!*in || memcmp(magic, MAGIC, 4) != 0 || version != VERSION)
+    {
+        throw std::runtime_error("'" + uri + "' is not a mesh stream");
+    }
+
+    // the counts are checked against what is left, so a corrupted header cannot trigger a huge allocation
+    std::streamoff position = in->tellg();
+    in->seekg(0, std::ios::end);
+    std::streamoff end = in->tellg();
+    in->seekg(position);
+    if (position < 0 || end < 0 || !*in)
+    {
+        throw std::runtime_error("mesh stream '" + uri + "' is not seekable");
+    }
+
+    Geometry batch;
+    uint32_t counts[2];
+    while (in->read(reinterpret_cast<char *>(counts), sizeof(counts)))
+    {
+        uint64_t vertex_size = uint64_t(counts[0]) * sizeof(Eigen::Vector3f) * (flags & FLAG_NORMALS ? 2 : 1);
+        uint64_t batch_size = vertex_size + uint64_t(counts[1]) * sizeof(uint32_t);
+        if (batch_size > uint64_t(end - in->tellg()))
+        {
+            throw std::runtime_error("truncated mesh stream '" + uri + "'");
+        }
+        batch.vertices.resize(counts[0]);
+        batch.indices.resize(counts[1]);
+        batch.normals.resize(flags & FLAG_NORMALS ? counts[0] : 0);
+        in->read(reinterpret_cast<char *>(batch.vertices.data()), batch.vertices.size() * sizeof(Eigen::Vector3f));
+        in->read(reinterpret_cast<char *>(batch.normals.data()), batch.normals.size() * sizeof(Eigen::Vector3f));
+        in->read(reinterpret_cast<char *>(batch.indices.data()), batch.indices.size() * sizeof(uint32_t));
+        if (!*in)
+        {
+            throw std::runtime_error("truncated mesh stream '" + uri + "'");
+        }
+        // the callers index the vertices without checks
+        bool valid = counts[1] % 3 == 0;
+        for (size_t i = 0; valid && i < batch.indices.size(); i++)
+        {
+            valid = batch.indices[i] < counts[0];
+        }
+        if (!valid)
+        {
+            throw std::runtime_error("corrupted mesh stream '" + uri + "'");
+        }
+        batch.invalidate_adjacency();
+        if (!callback(batch))
+        {
+            break;
+        }
+    }
+}
+
+MeshStream::Stats MeshStream::get_stats() const
+{
+    Stats stats;
+    for_each_batch([&stats](const Geometry &batch)
+                   {
+        stats.batches++;
+        stats.vertices += batch.vertices.size();
+        stats.triangles += batch.indices.size() / 3;
+        for(auto &vertex : batch.vertices) {
+            stats.bounds.extend(vertex);
+        }
+        return true; });
+    return stats;
+}
+
+static void check_options(const MeshStreamOptions &options)
+{
+    if (options.batch_triangles == 0)
+    {
+        throw std::invalid_argument("a mesh stream batch must hold at least one triangle");
+    }
+}
+
+void MeshStream::write(const std::string &uri, const Geometry &geometry, const MeshStreamOptions &options)
+{
+    check_options(options);
+    bool with_normals = geometry.normals.size() == geometry.vertices.size();
+    BatchWriter writer;
+    writer.header(with_normals ? FLAG_NORMALS : 0);
+    bool header_sent = false;
+
+    size_t triangle = 0;
+    size_t triangle_count = geometry.indices.size() / 3;
+    std::unordered_map<uint32_t, uint32_t> local;
+    std::vector<Eigen::Vector3f> positions, normals;
+    std::vector<uint32_t> indices;
+
+    FileSystem::get_entry(uri)->write([&]() -> std::pair<const void *, size_t>
+                                      {
+        if(!header_sent) {
+            header_sent = true;
+            return writer.get();
+        }
+        if(triangle == triangle_count) {
+            return {nullptr, 0};
+        }
+        local.clear();
+        positions.clear();
+        normals.clear();
+        indices.clear();
+        size_t end = std::min(triangle_count, triangle + options.batch_triangles);
+        for(; triangle < end; triangle++) {
+            for(int k = 0; k < 3; k++) {
+                uint32_t index = geometry.indices[3 * triangle + k];
+                auto [it, inserted] = local.emplace(index, positions.size());
+                if(inserted) {
+                    positions.push_back(geometry.vertices[index]);
+                    if(with_normals) {
+                        normals.push_back(geometry.normals[index]);
+                    }
+                }
+                indices.push_back(it->second);
+            }
+        }
+        writer.batch(positions, normals, indices);
+        return writer.get(); });
+}
+
+void MeshStream::convert_obj(const std::string &obj_uri, const std::string &uri, const MeshStreamOptions &options)
+{
+    check_options(options);
+    PagedVectorStore positions(options.cache_bytes / 2);
+    PagedVectorStore normals(options.cache_bytes / 2);
+
+    // first pass : spill the vertices to disk
+    size_t vertex_count = 0;
+    {
+        ObjReader reader(obj_uri);
+        Eigen::Vector3f vertex;
+        while (reader.next_vertex(vertex))
+        {
+            positions.set(vertex_count++, vertex);
+        }
+    }
+
+    // second pass : accumulate area weighted face normals
+    {
+        ObjReader reader(obj_uri, vertex_count);
+        uint32_t a, b, c;
+        while (reader.next_triangle(a, b, c))
+        {
+            Eigen::Vector3f pa = positions.get(a);
+            Eigen::Vector3f normal = (positions.get(b) - pa).cross(positions.get(c) - pa);
+            normals.add(a, normal);
+            normals.add(b, normal);
+            normals.add(c, normal);
+        }
+    }
+
+    // third pass : write the batches
+    ObjReader reader(obj_uri, vertex_count);
+    BatchWriter writer;
+    writer.header(FLAG_NORMALS);
+    bool header_sent = false;
+    std::unordered_map<uint32_t, uint32_t> local;
+    std::vector<Eigen::Vector3f> batch_positions, batch_normals;
+    std::vector<uint32_t> batch_indices;
+
+    FileSystem::get_entry(uri)->write([&]() -> std::pair<const void *, size_t>
+                                      {
+        if(!header_sent) {
+            header_sent = true;
+            return writer.get();
+        }
+        local.clear();
+        batch_positions.clear();
+        batch_normals.clear();
+        batch_indices.clear();
+        uint32_t triangle[3];
+        while(batch_indices.size() < 3 * options.batch_triangles && reader.next_triangle(triangle[0], triangle[1], triangle[2])) {
+            for(uint32_t index : triangle) {
+                auto [it, inserted] = local.emplace(index, batch_positions.size());
+                if(inserted) {
+                    batch_positions.push_back(positions.get(index));
+                    batch_normals.push_back(normals.get(index).normalized());
+                }
+                batch_indices.push_back(it->second);
+            }
+        }
+        if(batch_indices.empty()) {
+            return {nullptr, 0};
+        }
+        writer.batch(batch_positions, batch_normals, batch_indices);
+        return writer.get(); });
+}
@@ -1,5 +1,6 @@
 #include "Overlay2D.hpp"
 #include "VertexArray.hpp"
+#include "GLState.hpp"
 
 #include <GLFW/glfw3.h>
 
@@ -56,7 +57,7 @@ void Overlay2D::renderTexture(std::shared_ptr<Texture> texture, int x, int y, in
     glViewport(x, y, w, h);
 
     // turn off depth test
-    glDisable(GL_DEPTH_TEST);
+    GLState::get_instance().set_enabled(GL_DEPTH_TEST, false);
 
     //bind texture
     texture->to_unit(0);
@@ -66,7 +67,7 @@ void Overlay2D::renderTexture(std::shared_ptr<Texture> texture, int x, int y, in
     overlay2d_vao.render();
 
     // restore depth test
-    glEnable(GL_DEPTH_TEST);
+    GLState::get_instance().set_enabled(GL_DEPTH_TEST, true);
 
     // restore viewport
     auto dimensions = get_rendering_system()->get_application()->get_window()->get_dimensions();
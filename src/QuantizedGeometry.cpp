@@ -0,0 +1,166 @@
+#include "QuantizedGeometry.hpp"
+#include "Math.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+const char *QuantizedGeometry::GLSL_OCTAHEDRAL_DECODE = R"(
+vec3 octahedral_decode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+)";
+
+template <typename T>
+static T to_snorm(float value)
+{
+    constexpr float max = float((1 << (8 * sizeof(T) - 1)) - 1);
+    return T(std::lround(std::clamp(value, -1.0f, 1.0f) * max));
+}
+
+template <typename T>
+static float from_snorm(T value)
+{
+    constexpr float max = float((1 << (8 * sizeof(T) - 1)) - 1);
+    return std::max(value / max, -1.0f);
+}
+
+// the extent used for the quantization, flat axes are given a unit size to avoid dividing by zero
+static Eigen::Vector3f get_scale(const Eigen::AlignedBox3f &bounds)
+{
+    Eigen::Vector3f extent = bounds.sizes();
+    for (int i = 0; i < 3; i++)
+    {
+        if (extent[i] <= 0.0f)
+        {
+            extent[i] = 1.0f;
+        }
+    }
+    return extent;
+}
+
+QuantizedGeometry QuantizedGeometry::quantize(const Geometry &geometry, NormalBits normal_bits)
+{
+    QuantizedGeometry quantized;
+    quantized.indices = geometry.indices;
+    quantized.normal_bits = normal_bits;
+    quantized.stride = normal_bits == NormalBits::Bits16 ? 12 : 8;
+    for (auto &vertex : geometry.vertices)
+    {
+        quantized.bounds.extend(vertex);
+    }
+
+    const std::vector<Eigen::Vector3f> *normals = &geometry.normals;
+    Geometry with_normals;
+    if (normal_bits != NormalBits::None && geometry.normals.size() != geometry.vertices.size())
+    {
+        with_normals = geometry.copy();
+        with_normals.recompute_normals();
+        normals = &with_normals.normals;
+    }
+
+    Eigen::Vector3f min = quantized.bounds.min();
+    Eigen::Vector3f scale = get_scale(quantized.bounds);
+    quantized.data.resize(geometry.vertices.size() * quantized.stride, 0);
+    for (size_t i = 0; i < geometry.vertices.size(); i++)
+    {
+        uint8_t *vertex = quantized.data.data() + i * quantized.stride;
+        Eigen::Vector3f relative = (geometry.vertices[i] - min).cwiseQuotient(scale);
+        uint16_t position[3];
+        for (int k = 0; k < 3; k++)
+        {
+            position[k] = uint16_t(std::lround(std::clamp(relative[k], 0.0f, 1.0f) * 65535.0f));
+        }
+        memcpy(vertex, position, sizeof(position));
+
+        if (normal_bits == NormalBits::Bits8)
+        {
+            Eigen::Vector2f encoded = octahedral_encode((*normals)[i]);
+            int8_t normal[2] = {to_snorm<int8_t>(encoded.x()), to_snorm<int8_t>(encoded.y())};
+            memcpy(vertex + 6, normal, sizeof(normal));
+        }
+        else if (normal_bits == NormalBits::Bits16)
+        {
+            Eigen::Vector2f encoded = octahedral_encode((*normals)[i]);
+            int16_t normal[2] = {to_snorm<int16_t>(encoded.x()), to_snorm<int16_t>(encoded.y())};
+            memcpy(vertex + 8, normal, sizeof(normal));
+        }
+    }
+    return quantized;
+}
+
+Geometry QuantizedGeometry::dequantize() const
+{
+    Geometry geometry;
+    geometry.indices = indices;
+    size_t count = get_vertex_count();
+    geometry.vertices.resize(count);
+    if (normal_bits != NormalBits::None)
+    {
+        geometry.normals.resize(count);
+    }
+
+    Eigen::Vector3f min = bounds.min();
+    Eigen::Vector3f scale = get_scale(bounds);
+    for (size_t i = 0; i < count; i++)
+    {
+        const uint8_t *vertex = data.data() + i * stride;
+        uint16_t position[3];
+        memcpy(position, vertex, sizeof(position));
+        geometry.vertices[i] = min + Eigen::Vector3f(position[0], position[1], position[2]).cwiseProduct(scale) / 65535.0f;
+
+        if (normal_bits == NormalBits::Bits8)
+        {
+            int8_t normal[2];
+            memcpy(normal, vertex + 6, sizeof(normal));
+            geometry.normals[i] = octahedral_decode({from_snorm(normal[0]), from_snorm(normal[1])});
+        }
+        else if (normal_bits == NormalBits::Bits16)
+        {
+            int16_t normal[2];
+            memcpy(normal, vertex + 8, sizeof(normal));
+            geometry.normals[i] = octahedral_decode({from_snorm(normal[0]), from_snorm(normal[1])});
+        }
+    }
+    return geometry;
+}
+
+size_t QuantizedGeometry::get_vertex_count() const
+{
+    return stride == 0 ? 0 : data.size() / stride;
+}
+
+std::string QuantizedGeometry::get_position_format() const
+{
+    switch (normal_bits)
+    {
+    case NormalBits::Bits8:
+        return "wn[3] (c[2])";
+    case NormalBits::Bits16:
+        return "wn[3] (w s[2])";
+    default:
+        return "wn[3] (w)";
+    }
+}
+
+std::string QuantizedGeometry::get_normal_format() const
+{
+    switch (normal_bits)
+    {
+    case NormalBits::Bits8:
+        return "(w[3]) cn[2]";
+    case NormalBits::Bits16:
+        return "(w[4]) sn[2]";
+    default:
+        return "";
+    }
+}
+
+Eigen::Matrix4f QuantizedGeometry::get_dequantization_matrix() const
+{
+    Eigen::Affine3f transform = Eigen::Translation3f(bounds.min()) * Eigen::Scaling(get_scale(bounds));
+    return transform.matrix();
+}
@@ -0,0 +1,87 @@
+#include "RangeAllocator.hpp"
+
+#include <iterator>
+#include <stdexcept>
+
+RangeAllocator::RangeAllocator(size_t capacity)
+{
+    grow(capacity);
+}
+
+size_t RangeAllocator::allocate(size_t size)
+{
+    if (size == 0)
+    {
+        return 0;
+    }
+    for (auto it = free_ranges.begin(); it != free_ranges.end(); ++it)
+    {
+        if (it->second < size)
+        {
+            continue;
+        }
+        size_t offset = it->first;
+        size_t remaining = it->second - size;
+        free_ranges.erase(it);
+        if (remaining > 0)
+        {
+            free_ranges.emplace(offset + size, remaining);
+        }
+        return offset;
+    }
+    return INVALID;
+}
+
+void RangeAllocator::release(size_t offset, size_t size)
+{
+    if (size == 0)
+    {
+        return;
+    }
+    if (offset + size > capacity)
+    {
+        throw std::out_of_range("released range past the end of the arena");
+    }
+    auto next = free_ranges.lower_bound(offset);
+    if (next != free_ranges.end() && next->first == offset + size)
+    {
+        size += next->second;
+        next = free_ranges.erase(next);
+    }
+    if (next != free_ranges.begin())
+    {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset)
+        {
+            previous->second += size;
+            return;
+        }
+    }
+    free_ranges.emplace(offset, size);
+}
+
+void RangeAllocator::grow(size_t capacity_)
+{
+    if (capacity_ <= capacity)
+    {
+        return;
+    }
+    size_t offset = capacity;
+    capacity = capacity_;
+    release(offset, capacity - offset);
+}
+
+size_t RangeAllocator::get_capacity() const
+{
+    return capacity;
+}
+
+size_t RangeAllocator::get_free_size() const
+{
+    size_t size = 0;
+    for (auto &[offset, range] : free_ranges)
+    {
+        size += range;
+    }
+    return size;
+}
@@ -1,8 +1,18 @@
 #include "RenderingSystem.hpp"
+#include "GLState.hpp"
 
 #include <GL/glew.h>
 #include <GL/gl.h>
 
+const char *RenderingSystem::GLSL_CAMERA_BLOCK = R"(
+layout(std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec3 camera_position;
+};
+)";
+
 RenderingSystem::RenderingSystem(Application* application_) : application(application_)
 {
     camera = std::shared_ptr<Camera>(new PerspectiveCamera(60.0_deg, 1.0, 0.1f, 1000.0f));
@@ -16,13 +26,29 @@ RenderingSystem::~RenderingSystem()
 
 void RenderingSystem::init() {
     // set some common opengl defaults
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
+    GLState &state = GLState::get_instance();
+    state.set_enabled(GL_DEPTH_TEST, true);
+    state.set_depth_func(GL_LESS);
+    state.set_enabled(GL_CULL_FACE, true);
+    state.set_cull_face(GL_BACK);
     glFrontFace(GL_CCW);
     glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+    // the camera block, shared by all the programs
+    UniformBuffer::set_block_binding("Camera", CAMERA_BINDING);
+    camera_buffer = std::make_unique<UniformBuffer>("m4 m4 m4 v3");
+}
+
+void RenderingSystem::update_camera_block() {
+    Eigen::Matrix4f view = camera->get_view();
+    Eigen::Matrix4f projection = camera->get_projection();
+    camera_buffer->set(0, view);
+    camera_buffer->set(1, projection);
+    camera_buffer->set(2, Eigen::Matrix4f(projection * view));
+    camera_buffer->set(3, camera->get_position());
+    camera_buffer->upload();
+    camera_buffer->bind(CAMERA_BINDING);
 }
 
 void RenderingSystem::init_passes() {
@@ -144,6 +170,7 @@ std::shared_ptr<Pass> RenderingSystem::get_pass(const std::string &name) {
 
 void RenderingSystem::render()
 {
+    update_camera_block();
     for (auto &passInfo : passes)
     {
         if (passInfo.enabled)
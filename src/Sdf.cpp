@@ -0,0 +1,265 @@
+#include "Sdf.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace sdf
+{
+
+    Sdf sphere(float radius)
+    {
+        return [radius](const Eigen::Vector3f &p)
+        { return p.norm() - radius; };
+    }
+
+    Sdf box(const Eigen::Vector3f &half_extents)
+    {
+        return [half_extents](const Eigen::Vector3f &p)
+        {
+            Eigen::Vector3f q = p.cwiseAbs() - half_extents;
+            return q.cwiseMax(0.0f).norm() + std::min(q.maxCoeff(), 0.0f);
+        };
+    }
+
+    Sdf torus(float major_radius, float minor_radius)
+    {
+        return [major_radius, minor_radius](const Eigen::Vector3f &p)
+        {
+            Eigen::Vector2f q(p.head<2>().norm() - major_radius, p.z());
+            return q.norm() - minor_radius;
+        };
+    }
+
+    Sdf translated(Sdf a, const Eigen::Vector3f &translation)
+    {
+        return [a, translation](const Eigen::Vector3f &p)
+        { return a(p - translation); };
+    }
+
+    Sdf unite(Sdf a, Sdf b)
+    {
+        return [a, b](const Eigen::Vector3f &p)
+        { return std::min(a(p), b(p)); };
+    }
+
+    Sdf intersect(Sdf a, Sdf b)
+    {
+        return [a, b](const Eigen::Vector3f &p)
+        { return std::max(a(p), b(p)); };
+    }
+
+    Sdf subtract(Sdf a, Sdf b)
+    {
+        return [a, b](const Eigen::Vector3f &p)
+        { return std::max(a(p), -b(p)); };
+    }
+
+    Sdf smooth_union(Sdf a, Sdf b, float k)
+    {
+        return [a, b, k](const Eigen::Vector3f &p)
+        {
+            float da = a(p);
+            float db = b(p);
+            float h = std::clamp(0.5f + 0.5f * (db - da) / k, 0.0f, 1.0f);
+            return db + (da - db) * h - k * h * (1.0f - h);
+        };
+    }
+
+    static constexpr int BLOCK_SIZE = 32; // cells per block side
+
+    // output of the first pass for one block
+    struct Block
+    {
+        std::vector<uint32_t> cells;            // global ids of the cells that hold a vertex, in increasing order
+        std::vector<Eigen::Vector3f> positions; // one per cell
+        std::vector<uint32_t> quads;            // 4 cell ids per quad, already in the right winding order
+        uint32_t first_vertex = 0;              // index of the first vertex of the block in the final geometry
+    };
+
+    Geometry mesh(const Sdf &sdf, const Eigen::Vector3f &min, const Eigen::Vector3f &max, int resolution)
+    {
+        assert(resolution > 0);
+        Eigen::Vector3f extent = max - min;
+        float cell_size = extent.maxCoeff() / resolution;
+        Eigen::Vector3i n = (extent / cell_size).array().ceil().cast<int>().cwiseMax(1);
+        assert(double(n.x()) * n.y() * n.z() < double(UINT32_MAX) && "grid too large");
+
+        Eigen::Vector3i blocks = (n.array() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        std::vector<Block> block_data(blocks.x() * blocks.y() * blocks.z());
+
+        auto cell_id = [&](int x, int y, int z) -> uint32_t
+        { return x + n.x() * (y + n.y() * z); };
+
+        // first pass : sample each block, place a vertex in every cell crossed by the surface, and list the quads by cell ids
+#pragma omp parallel for schedule(dynamic)
+        for (int b = 0; b < (int)block_data.size(); b++)
+        {
+            Block &block = block_data[b];
+            Eigen::Vector3i lo(b % blocks.x() * BLOCK_SIZE, b / blocks.x() % blocks.y() * BLOCK_SIZE, b / (blocks.x() * blocks.y()) * BLOCK_SIZE);
+            Eigen::Vector3i hi = (lo.array() + BLOCK_SIZE).cwiseMin(n.array());
+            Eigen::Vector3i s = hi - lo + Eigen::Vector3i::Ones(); // samples per side, the last layer is shared with the next block
+
+            std::vector<float> samples(s.x() * s.y() * s.z());
+            for (int z = 0; z < s.z(); z++)
+            {
+                for (int y = 0; y < s.y(); y++)
+                {
+                    for (int x = 0; x < s.x(); x++)
+                    {
+                        Eigen::Vector3f p = min + cell_size * (lo + Eigen::Vector3i(x, y, z)).cast<float>();
+                        samples[x + s.x() * (y + s.y() * z)] = sdf(p);
+                    }
+                }
+            }
+            auto sample = [&](int x, int y, int z)
+            { return samples[(x - lo.x()) + s.x() * ((y - lo.y()) + s.y() * (z - lo.z()))]; };
+
+            for (int z = lo.z(); z < hi.z(); z++)
+            {
+                for (int y = lo.y(); y < hi.y(); y++)
+                {
+                    for (int x = lo.x(); x < hi.x(); x++)
+                    {
+                        // corner k is at (x + (k & 1), y + ((k >> 1) & 1), z + (k >> 2))
+                        float values[8];
+                        int inside = 0;
+                        for (int k = 0; k < 8; k++)
+                        {
+                            values[k] = sample(x + (k & 1), y + ((k >> 1) & 1), z + (k >> 2));
+                            inside += values[k] < 0.0f;
+                        }
+                        if (inside == 0 || inside == 8)
+                        {
+                            continue;
+                        }
+
+                        // the vertex is the average of the crossings on the 12 edges of the cell
+                        Eigen::Vector3f sum = Eigen::Vector3f::Zero();
+                        int crossings = 0;
+                        for (int k = 0; k < 8; k++)
+                        {
+                            for (int axis = 0; axis < 3; axis++)
+                            {
+                                int other = k | (1 << axis);
+                                if (other == k || (values[k] < 0.0f) == (values[other] < 0.0f))
+                                {
+                                    continue;
+                                }
+                                float t = values[k] / (values[k] - values[other]);
+                                Eigen::Vector3f corner(float(k & 1), float((k >> 1) & 1), float(k >> 2));
+                                corner[axis] += t;
+                                sum += corner;
+                                crossings++;
+                            }
+                        }
+                        Eigen::Vector3f local = sum / crossings;
+                        block.cells.push_back(cell_id(x, y, z));
+                        block.positions.push_back(min + cell_size * (Eigen::Vector3f(x, y, z) + local));
+
+                        // each cell owns the three edges leaving its lowest corner, a crossing edge yields a quad between the 4 cells around it
+                        for (int axis = 0; axis < 3; axis++)
+                        {
+                            int u = (axis + 1) % 3;
+                            int v = (axis + 2) % 3;
+                            Eigen::Vector3i p(x, y, z);
+                            if (p[u] == 0 || p[v] == 0)
+                            {
+                                continue;
+                            }
+                            bool start_inside = values[0] < 0.0f;
+                            if (start_inside == (values[1 << axis] < 0.0f))
+                            {
+                                continue;
+                            }
+                            Eigen::Vector3i du = Eigen::Vector3i::Unit(u);
+                            Eigen::Vector3i dv = Eigen::Vector3i::Unit(v);
+                            Eigen::Vector3i c[4] = {p, p - du, p - du - dv, p - dv};
+                            // counterclockwise around +axis, reversed when the surface faces -axis
+                            if (!start_inside)
+                            {
+                                std::swap(c[1], c[3]);
+                            }
+                            for (auto &cell : c)
+                            {
+                                block.quads.push_back(cell_id(cell.x(), cell.y(), cell.z()));
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // second pass : give each block its range of vertices
+        Geometry geometry;
+        uint32_t vertex_count = 0;
+        for (auto &block : block_data)
+        {
+            block.first_vertex = vertex_count;
+            vertex_count += block.positions.size();
+        }
+        geometry.vertices.resize(vertex_count);
+        for (auto &block : block_data)
+        {
+            std::copy(block.positions.begin(), block.positions.end(), geometry.vertices.begin() + block.first_vertex);
+            block.positions = {};
+        }
+
+        // third pass : resolve the cell ids of the quads, looking into the neighbouring blocks when needed
+        auto vertex_of = [&](uint32_t id) -> uint32_t
+        {
+            int x = id % n.x();
+            int y = id / n.x() % n.y();
+            int z = id / (n.x() * n.y());
+            const Block &owner = block_data[x / BLOCK_SIZE + blocks.x() * (y / BLOCK_SIZE + blocks.y() * (z / BLOCK_SIZE))];
+            auto it = std::lower_bound(owner.cells.begin(), owner.cells.end(), id);
+            assert(it != owner.cells.end() && *it == id);
+            return owner.first_vertex + (it - owner.cells.begin());
+        };
+
+        std::vector<size_t> first_index(block_data.size() + 1, 0);
+        for (size_t b = 0; b < block_data.size(); b++)
+        {
+            first_index[b + 1] = first_index[b] + block_data[b].quads.size() / 4 * 6;
+        }
+        geometry.indices.resize(first_index.back());
+
+#pragma omp parallel for schedule(dynamic)
+        for (int b = 0; b < (int)block_data.size(); b++)
+        {
+            const auto &quads = block_data[b].quads;
+            uint32_t *out = geometry.indices.data() + first_index[b];
+            for (size_t q = 0; q < quads.size(); q += 4)
+            {
+                uint32_t a = vertex_of(quads[q]);
+                uint32_t bb = vertex_of(quads[q + 1]);
+                uint32_t c = vertex_of(quads[q + 2]);
+                uint32_t d = vertex_of(quads[q + 3]);
+                *out++ = a;
+                *out++ = bb;
+                *out++ = c;
+                *out++ = c;
+                *out++ = d;
+                *out++ = a;
+            }
+        }
+
+        // normals from the gradient (central differences)
+        geometry.normals.resize(vertex_count);
+        float h = cell_size * 0.5f;
+#pragma omp parallel for
+        for (int i = 0; i < (int)vertex_count; i++)
+        {
+            const Eigen::Vector3f &p = geometry.vertices[i];
+            Eigen::Vector3f gradient;
+            for (int axis = 0; axis < 3; axis++)
+            {
+                Eigen::Vector3f d = Eigen::Vector3f::Unit(axis) * h;
+                gradient[axis] = sdf(p + d) - sdf(p - d);
+            }
+            geometry.normals[i] = gradient.normalized();
+        }
+
+        return geometry;
+    }
+}
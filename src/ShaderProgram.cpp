@@ -1,12 +1,24 @@
 #include "ShaderProgram.hpp"
+#include "GLState.hpp"
+#include "UniformBuffer.hpp"
+#include "FileSystem.hpp"
+#include "Logging.hpp"
+#include "Md5.hpp"
 
 #include <GL/glew.h>
 #include <GL/gl.h>
 
 #include <cassert>
+#include <cstring>
 #include <vector>
 #include <stdexcept>
 
+#include <fmt/format.h>
+
+#if !defined(NDEBUG) || defined(ZENGINE_VALIDATE_UNIFORMS)
+#define VALIDATE_UNIFORMS
+#endif
+
 static uint32_t get_gl_shader_type(ShaderType shaderType)
 {
     switch (shaderType)
@@ -47,81 +59,189 @@ static std::string get_shader_type_str(ShaderType shaderType)
     throw std::runtime_error("unknown shader type");
 }
 
-ShaderProgram::ShaderProgram(const std::vector<ShaderDefinition> &shaderDefinitions)
+static std::string binary_cache;
+
+static const char BINARY_MAGIC[4] = {'Z', 'P', 'R', 'G'};
+
+void ShaderProgram::set_binary_cache(const std::string &cache_directory)
 {
+    if (!cache_directory.empty())
+    {
+        FileSystem::get_entry(cache_directory)->create_directories();
+    }
+    binary_cache = cache_directory;
+}
 
-    std::vector<uint32_t> shaderIds;
+const std::string &ShaderProgram::get_binary_cache()
+{
+    return binary_cache;
+}
 
-    // compile shaders
+std::string ShaderProgram::get_binary_key(const std::vector<ShaderDefinition> &shaderDefinitions)
+{
+    // binaries are only valid for the driver that produced them
+    Md5Digest md5;
+    for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+    {
+        std::string value((const char *)glGetString(name));
+        md5.update(value.c_str(), value.size() + 1);
+    }
     for (auto &shaderDef : shaderDefinitions)
     {
+        uint8_t type = uint8_t(shaderDef.type);
+        md5.update(&type, 1);
+        md5.update(shaderDef.code.c_str(), shaderDef.code.size() + 1);
+    }
+    return md5.hexdigest();
+}
+
+bool ShaderProgram::load_binary(const std::string &uri)
+{
+    auto entry = FileSystem::get_entry(uri);
+    if (!entry->exists())
+    {
+        return false;
+    }
+    Blob blob = entry->read();
+    const uint8_t *data = (const uint8_t *)blob.get_ptr();
+    if (blob.get_size() <= 8 || memcmp(data, BINARY_MAGIC, 4) != 0)
+    {
+        return false;
+    }
+    uint32_t format;
+    memcpy(&format, data + 4, sizeof(format));
 
+    // the driver rejects binaries it cannot use anymore (updated driver, other gpu ...)
+    id = glCreateProgram();
+    glProgramBinary(id, format, data + 8, blob.get_size() - 8);
+    int32_t linked = 0;
+    glGetProgramiv(id, GL_LINK_STATUS, &linked);
+    if (!linked)
+    {
+        glDeleteProgram(id);
+        return false;
+    }
+    return true;
+}
+
+void ShaderProgram::save_binary(const std::string &uri)
+{
+    int32_t length = 0;
+    glGetProgramiv(id, GL_PROGRAM_BINARY_LENGTH, &length);
+    auto entry = FileSystem::get_entry(uri);
+    if (length <= 0 || entry->is_readonly())
+    {
+        return;
+    }
+    std::vector<uint8_t> data(8 + length);
+    uint32_t format;
+    glGetProgramBinary(id, length, &length, &format, data.data() + 8);
+    memcpy(data.data(), BINARY_MAGIC, 4);
+    memcpy(data.data() + 4, &format, sizeof(format));
+    try
+    {
+        entry->write(data.data(), 8 + length);
+    }
+    catch (const std::runtime_error &e)
+    {
+        // the cache is an optimization, the program is usable anyway
+        LOG(WARNING) << "could not cache the program binary : " << e.what();
+    }
+}
+
+void ShaderProgram::submit(const std::vector<ShaderDefinition> &shaderDefinitions, bool retrievable)
+{
+    // compile shaders, the status is only queried by finish() so that the driver may compile in the background
+    for (auto &shaderDef : shaderDefinitions)
+    {
         auto shaderId = glCreateShader(get_gl_shader_type(shaderDef.type));
         const GLchar *source = (const GLchar *)shaderDef.code.c_str();
         glShaderSource(shaderId, 1, &source, nullptr);
         glCompileShader(shaderId);
-
-        int32_t compiled = 0;
-        glGetShaderiv(shaderId, GL_COMPILE_STATUS, &compiled);
-        if (!compiled)
-        {
-            int32_t len;
-            glGetShaderiv(shaderId, GL_INFO_LOG_LENGTH, &len);
-            std::string message;
-            message.reserve(len);
-            glGetShaderInfoLog(shaderId, len, &len, (GLchar *)message.data());
-            glDeleteShader(shaderId);
-            throw std::runtime_error(get_shader_type_str(shaderDef.type) + " shader compilation failed : " + message);
-        }
-        else
-        {
-            shaderIds.push_back(shaderId);
-        }
+        pending_shaders.push_back({shaderDef.type, shaderId});
     }
 
     // create program
     id = glCreateProgram();
 
     // attach compiled shaders to the program
-    for (auto shaderId : shaderIds)
+    for (auto &[type, shaderId] : pending_shaders)
     {
         glAttachShader(id, shaderId);
     }
 
+    // the binary is only available if asked before linking
+    if (retrievable)
+    {
+        glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
     // link the program
     glLinkProgram(id);
+    pending = true;
+}
+
+void ShaderProgram::finish()
+{
+    pending = false;
+    std::string &error = build_error;
+
+    // check for compilation errors
+    for (auto &[type, shaderId] : pending_shaders)
+    {
+        int32_t compiled = 0;
+        glGetShaderiv(shaderId, GL_COMPILE_STATUS, &compiled);
+        if (!compiled && error.empty())
+        {
+            int32_t len;
+            glGetShaderiv(shaderId, GL_INFO_LOG_LENGTH, &len);
+            std::string message(len, '\0');
+            glGetShaderInfoLog(shaderId, len, &len, (GLchar *)message.data());
+            error = get_shader_type_str(type) + " shader compilation failed : " + message;
+        }
+    }
 
     // check for linking errors
     int32_t linked = 0;
     glGetProgramiv(id, GL_LINK_STATUS, &linked);
-    if (!linked)
+    if (!linked && error.empty())
     {
-
         int32_t len;
         glGetProgramiv(id, GL_INFO_LOG_LENGTH, &len);
-        std::string message;
-        message.reserve(len);
+        std::string message(len, '\0');
         glGetProgramInfoLog(id, len, &len, (GLchar *)message.data());
-        glDeleteProgram(id);
-        for (auto shaderId : shaderIds)
-        {
-            glDeleteShader(shaderId);
-        }
-        throw std::runtime_error("Could not link shader program : " + message);
+        error = "Could not link shader program : " + message;
     }
 
     // detach and delete shaders
-    for (auto shaderId : shaderIds)
+    for (auto &[type, shaderId] : pending_shaders)
     {
         glDetachShader(id, shaderId);
         glDeleteShader(shaderId);
     }
+    pending_shaders.clear();
 
+    if (!error.empty())
+    {
+        glDeleteProgram(id);
+        id = 0;
+        throw std::runtime_error(error);
+    }
+
+    if (!cache_uri.empty())
+    {
+        save_binary(cache_uri);
+    }
+    introspect();
+}
+
+void ShaderProgram::introspect()
+{
     // count uniforms
     int32_t uniformCount;
     glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &uniformCount);
 
-    // get uniform names and locations ans store them in a map, will speed up uniform setting
+    // get uniform names, locations and types and store them by hash, will speed up uniform setting
     for (int32_t i = 0; i < uniformCount; i++)
     {
         char name[256];
@@ -129,85 +249,426 @@ ShaderProgram::ShaderProgram(const std::vector<ShaderDefinition> &shaderDefiniti
         int32_t size;
         uint32_t type;
         glGetActiveUniform(id, i, 256, &length, &size, &type, name);
-        uniformLocations[name] = glGetUniformLocation(id, name);
+        int32_t location = glGetUniformLocation(id, name);
+        if (location < 0)
+        {
+            continue; // member of a uniform block
+        }
+        std::string_view view(name, length);
+        uniforms[UniformName::get_hash(view)] = UniformInfo{std::string(view), location, type};
+        // arrays are reported as "name[0]", but can be set as "name" too
+        if (view.size() > 3 && view.substr(view.size() - 3) == "[0]")
+        {
+            view.remove_suffix(3);
+            uniforms[UniformName::get_hash(view)] = UniformInfo{std::string(view), location, type};
+        }
     }
 
+    // the shared uniform blocks are bound to their binding points
+    for (auto &[block, binding] : UniformBuffer::get_block_bindings())
+    {
+        uint32_t index = glGetUniformBlockIndex(id, block.c_str());
+        if (index != GL_INVALID_INDEX)
+        {
+            glUniformBlockBinding(id, index, binding);
+        }
+    }
+}
+
+ShaderProgram::ShaderProgram(const std::vector<ShaderDefinition> &shaderDefinitions, bool deferred)
+{
+    if (!binary_cache.empty() && GLEW_ARB_get_program_binary)
+    {
+        cache_uri = binary_cache + "/" + get_binary_key(shaderDefinitions) + ".bin";
+    }
+
+    // a warm start does not compile anything
+    if (!cache_uri.empty() && load_binary(cache_uri))
+    {
+        cache_uri.clear();
+        introspect();
+        return;
+    }
+
+    submit(shaderDefinitions, !cache_uri.empty());
+    if (!deferred)
+    {
+        finish();
+    }
+}
+
+ShaderProgram::ShaderProgram(const std::vector<ShaderDefinition> &shaderDefinitions) : ShaderProgram(shaderDefinitions, false)
+{
 }
 
 ShaderProgram::ShaderProgram(const std::string &vertex_shader, const std::string &fragment_shader) : ShaderProgram({{ShaderType::Vertex, vertex_shader}, {ShaderType::Fragment, fragment_shader}})
 {
 }
 
-int32_t ShaderProgram::get_uniform_location(const std::string &name)
+// how each type is checked and sent to a program
+template <typename T>
+struct UniformTraits;
+
+template <>
+struct UniformTraits<int32_t>
 {
-    auto it = uniformLocations.find(name);
-    if (it != uniformLocations.end())
+    static bool accepts(uint32_t type)
     {
-        return it->second;
+        // samplers and images are set with their unit, as int
+        switch (type)
+        {
+        case GL_INT:
+        case GL_BOOL:
+        case GL_SAMPLER_1D:
+        case GL_SAMPLER_2D:
+        case GL_SAMPLER_3D:
+        case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_1D_SHADOW:
+        case GL_SAMPLER_2D_SHADOW:
+        case GL_SAMPLER_1D_ARRAY:
+        case GL_SAMPLER_2D_ARRAY:
+        case GL_SAMPLER_1D_ARRAY_SHADOW:
+        case GL_SAMPLER_2D_ARRAY_SHADOW:
+        case GL_SAMPLER_2D_MULTISAMPLE:
+        case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        case GL_SAMPLER_CUBE_SHADOW:
+        case GL_SAMPLER_BUFFER:
+        case GL_SAMPLER_2D_RECT:
+        case GL_SAMPLER_2D_RECT_SHADOW:
+        case GL_SAMPLER_CUBE_MAP_ARRAY:
+        case GL_SAMPLER_CUBE_MAP_ARRAY_SHADOW:
+        case GL_INT_SAMPLER_1D:
+        case GL_INT_SAMPLER_2D:
+        case GL_INT_SAMPLER_3D:
+        case GL_INT_SAMPLER_CUBE:
+        case GL_INT_SAMPLER_1D_ARRAY:
+        case GL_INT_SAMPLER_2D_ARRAY:
+        case GL_INT_SAMPLER_2D_MULTISAMPLE:
+        case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        case GL_INT_SAMPLER_BUFFER:
+        case GL_INT_SAMPLER_2D_RECT:
+        case GL_INT_SAMPLER_CUBE_MAP_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_1D:
+        case GL_UNSIGNED_INT_SAMPLER_2D:
+        case GL_UNSIGNED_INT_SAMPLER_3D:
+        case GL_UNSIGNED_INT_SAMPLER_CUBE:
+        case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
+        case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+        case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
+        case GL_UNSIGNED_INT_SAMPLER_CUBE_MAP_ARRAY:
+        case GL_IMAGE_1D:
+        case GL_IMAGE_2D:
+        case GL_IMAGE_3D:
+        case GL_IMAGE_2D_RECT:
+        case GL_IMAGE_CUBE:
+        case GL_IMAGE_BUFFER:
+        case GL_IMAGE_1D_ARRAY:
+        case GL_IMAGE_2D_ARRAY:
+        case GL_IMAGE_CUBE_MAP_ARRAY:
+        case GL_IMAGE_2D_MULTISAMPLE:
+        case GL_IMAGE_2D_MULTISAMPLE_ARRAY:
+        case GL_INT_IMAGE_1D:
+        case GL_INT_IMAGE_2D:
+        case GL_INT_IMAGE_3D:
+        case GL_INT_IMAGE_2D_RECT:
+        case GL_INT_IMAGE_CUBE:
+        case GL_INT_IMAGE_BUFFER:
+        case GL_INT_IMAGE_1D_ARRAY:
+        case GL_INT_IMAGE_2D_ARRAY:
+        case GL_INT_IMAGE_CUBE_MAP_ARRAY:
+        case GL_INT_IMAGE_2D_MULTISAMPLE:
+        case GL_INT_IMAGE_2D_MULTISAMPLE_ARRAY:
+        case GL_UNSIGNED_INT_IMAGE_1D:
+        case GL_UNSIGNED_INT_IMAGE_2D:
+        case GL_UNSIGNED_INT_IMAGE_3D:
+        case GL_UNSIGNED_INT_IMAGE_2D_RECT:
+        case GL_UNSIGNED_INT_IMAGE_CUBE:
+        case GL_UNSIGNED_INT_IMAGE_BUFFER:
+        case GL_UNSIGNED_INT_IMAGE_1D_ARRAY:
+        case GL_UNSIGNED_INT_IMAGE_2D_ARRAY:
+        case GL_UNSIGNED_INT_IMAGE_CUBE_MAP_ARRAY:
+        case GL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE:
+        case GL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE_ARRAY:
+            return true;
+        default:
+            return false;
+        }
     }
-    else
+    static void set(uint32_t program, int32_t location, int32_t value) { glProgramUniform1i(program, location, value); }
+};
+
+template <>
+struct UniformTraits<uint32_t>
+{
+    static bool accepts(uint32_t type) { return type == GL_UNSIGNED_INT || type == GL_BOOL; }
+    static void set(uint32_t program, int32_t location, uint32_t value) { glProgramUniform1ui(program, location, value); }
+};
+
+template <>
+struct UniformTraits<float>
+{
+    static bool accepts(uint32_t type) { return type == GL_FLOAT; }
+    static void set(uint32_t program, int32_t location, float value) { glProgramUniform1f(program, location, value); }
+};
+
+template <>
+struct UniformTraits<Eigen::Vector2f>
+{
+    static bool accepts(uint32_t type) { return type == GL_FLOAT_VEC2; }
+    static void set(uint32_t program, int32_t location, const Eigen::Vector2f &value) { glProgramUniform2fv(program, location, 1, value.data()); }
+};
+
+template <>
+struct UniformTraits<Eigen::Vector3f>
+{
+    static bool accepts(uint32_t type) { return type == GL_FLOAT_VEC3; }
+    static void set(uint32_t program, int32_t location, const Eigen::Vector3f &value) { glProgramUniform3fv(program, location, 1, value.data()); }
+};
+
+template <>
+struct UniformTraits<Eigen::Vector4f>
+{
+    static bool accepts(uint32_t type) { return type == GL_FLOAT_VEC4; }
+    static void set(uint32_t program, int32_t location, const Eigen::Vector4f &value) { glProgramUniform4fv(program, location, 1, value.data()); }
+};
+
+template <>
+struct UniformTraits<Eigen::Matrix2f>
+{
+    static bool accepts(uint32_t type) { return type == GL_FLOAT_MAT2; }
+    static void set(uint32_t program, int32_t location, const Eigen::Matrix2f &value) { glProgramUniformMatrix2fv(program, location, 1, GL_FALSE, value.data()); }
+};
+
+template <>
+struct UniformTraits<Eigen::Matrix3f>
+{
+    static bool accepts(uint32_t type) { return type == GL_FLOAT_MAT3; }
+    static void set(uint32_t program, int32_t location, const Eigen::Matrix3f &value) { glProgramUniformMatrix3fv(program, location, 1, GL_FALSE, value.data()); }
+};
+
+template <>
+struct UniformTraits<Eigen::Matrix4f>
+{
+    static bool accepts(uint32_t type) { return type == GL_FLOAT_MAT4; }
+    static void set(uint32_t program, int32_t location, const Eigen::Matrix4f &value) { glProgramUniformMatrix4fv(program, location, 1, GL_FALSE, value.data()); }
+};
+
+template <typename T>
+int32_t ShaderProgram::get_uniform_location(const UniformName &name)
+{
+    wait();
+    auto it = uniforms.find(name.hash);
+    if (it == uniforms.end())
     {
-        auto location = glGetUniformLocation(id, name.c_str());
+        // not reported by the program, e.g. an element of an array "lights[2]"
+        std::string str(name.name);
+        auto location = glGetUniformLocation(id, str.c_str());
         if (location < 0)
         {
-            throw std::runtime_error("uniform " + name + " not found");
+            throw std::runtime_error("uniform " + str + " not found");
         }
-        uniformLocations[name] = location;
-        return location;
+        uint32_t type = 0; // unknown, unless it is an array element
+        auto bracket = name.name.find('[');
+        if (bracket != std::string_view::npos)
+        {
+            auto array = uniforms.find(UniformName::get_hash(name.name.substr(0, bracket)));
+            type = array != uniforms.end() ? array->second.type : 0;
+        }
+        it = uniforms.emplace(name.hash, UniformInfo{str, location, type}).first;
+    }
+#ifdef VALIDATE_UNIFORMS
+    const UniformInfo &info = it->second;
+    if (info.name != name.name)
+    {
+        throw std::runtime_error(fmt::format("uniform names {} and {} have the same hash", info.name, name.name));
+    }
+    if (info.type != 0 && !UniformTraits<T>::accepts(info.type))
+    {
+        throw std::runtime_error(fmt::format("uniform {} is set with a value of the wrong type (glsl type 0x{:x})", info.name, info.type));
+    }
+#endif
+    return it->second.location;
+}
+
+template <typename T>
+void Uniform<T>::set(const T &value) const
+{
+    if (!is_valid())
+    {
+        return;
     }
+    UniformTraits<T>::set(program, location, value);
+}
+
+template <typename T>
+Uniform<T> ShaderProgram::uniform(const UniformName &name)
+{
+    return Uniform<T>(id, get_uniform_location<T>(name));
 }
 
+#define INSTANTIATE_UNIFORM(T)  \
+    template class Uniform<T>; \
+    template Uniform<T> ShaderProgram::uniform<T>(const UniformName &name);
+
+INSTANTIATE_UNIFORM(int32_t)
+INSTANTIATE_UNIFORM(uint32_t)
+INSTANTIATE_UNIFORM(float)
+INSTANTIATE_UNIFORM(Eigen::Vector2f)
+INSTANTIATE_UNIFORM(Eigen::Vector3f)
+INSTANTIATE_UNIFORM(Eigen::Vector4f)
+INSTANTIATE_UNIFORM(Eigen::Matrix2f)
+INSTANTIATE_UNIFORM(Eigen::Matrix3f)
+INSTANTIATE_UNIFORM(Eigen::Matrix4f)
+
 ShaderProgram::~ShaderProgram()
 {
+    for (auto &[type, shaderId] : pending_shaders)
+    {
+        glDeleteShader(shaderId);
+    }
+    GLState::get_instance().forget_program(id);
     glDeleteProgram(id);
 }
 
+static bool has_parallel_compile()
+{
+    return GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile;
+}
+
+std::vector<std::shared_ptr<ShaderProgram>> ShaderProgram::build(const std::vector<std::vector<ShaderDefinition>> &programs)
+{
+    static bool threads_set = false;
+    if (!threads_set && has_parallel_compile())
+    {
+        // let the driver choose the number of compiler threads
+        if (GLEW_KHR_parallel_shader_compile)
+        {
+            glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        }
+        else
+        {
+            glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+        }
+        threads_set = true;
+    }
+
+    std::vector<std::shared_ptr<ShaderProgram>> built;
+    built.reserve(programs.size());
+    for (auto &shaderDefinitions : programs)
+    {
+        built.push_back(std::shared_ptr<ShaderProgram>(new ShaderProgram(shaderDefinitions, true)));
+    }
+    return built;
+}
+
+bool ShaderProgram::is_ready()
+{
+    if (!pending)
+    {
+        return build_error.empty();
+    }
+    if (!has_parallel_compile())
+    {
+        return true; // no way to know without waiting, the first use will
+    }
+    // the link completes after the compilation of the attached shaders
+    int32_t completed = 0;
+    glGetProgramiv(id, GL_COMPLETION_STATUS_KHR, &completed);
+    if (!completed)
+    {
+        return false;
+    }
+    // the status can be checked now without waiting, a failed build is never ready
+    try
+    {
+        finish();
+    }
+    catch (const std::runtime_error &)
+    {
+        return false;
+    }
+    return true;
+}
+
+bool ShaderProgram::has_failed() const
+{
+    return !build_error.empty();
+}
+
+const std::string &ShaderProgram::get_build_error() const
+{
+    return build_error;
+}
+
+void ShaderProgram::wait()
+{
+    if (pending)
+    {
+        finish();
+    }
+    else if (!build_error.empty())
+    {
+        throw std::runtime_error(build_error);
+    }
+}
+
 void ShaderProgram::use()
 {
-    glUseProgram(id);
+    wait();
+    GLState::get_instance().use_program(id);
 }
 
 void ShaderProgram::run(int vertices)
 {
     assert(vertices % 3 == 0);
-    glUseProgram(id);
+    use();
     glDrawArrays(GL_TRIANGLES, 0, vertices);
 }
 
-void ShaderProgram::set_uniform(const std::string &name, int32_t value)
+void ShaderProgram::set_uniform(const UniformName &name, int32_t value)
 {
-    glUniform1i(get_uniform_location(name), value);
+    UniformTraits<int32_t>::set(id, get_uniform_location<int32_t>(name), value);
 }
 
-void ShaderProgram::set_uniform(const std::string &name, uint32_t value)
+void ShaderProgram::set_uniform(const UniformName &name, uint32_t value)
 {
-    glUniform1ui(get_uniform_location(name), value);
+    UniformTraits<uint32_t>::set(id, get_uniform_location<uint32_t>(name), value);
 }
-void ShaderProgram::set_uniform(const std::string &name, float value)
+
+void ShaderProgram::set_uniform(const UniformName &name, float value)
 {
-    glUniform1f(get_uniform_location(name), value);
+    UniformTraits<float>::set(id, get_uniform_location<float>(name), value);
 }
-void ShaderProgram::set_uniform(const std::string &name, const Eigen::Vector2f &value)
+
+void ShaderProgram::set_uniform(const UniformName &name, const Eigen::Vector2f &value)
 {
-    glUniform2fv(get_uniform_location(name), 1, value.data());
+    UniformTraits<Eigen::Vector2f>::set(id, get_uniform_location<Eigen::Vector2f>(name), value);
 }
-void ShaderProgram::set_uniform(const std::string &name, const Eigen::Vector3f &value)
+
+void ShaderProgram::set_uniform(const UniformName &name, const Eigen::Vector3f &value)
 {
-    glUniform3fv(get_uniform_location(name), 1, value.data());
+    UniformTraits<Eigen::Vector3f>::set(id, get_uniform_location<Eigen::Vector3f>(name), value);
 }
-void ShaderProgram::set_uniform(const std::string &name, const Eigen::Vector4f &value)
+
+void ShaderProgram::set_uniform(const UniformName &name, const Eigen::Vector4f &value)
 {
-    glUniform4fv(get_uniform_location(name), 1, value.data());
+    UniformTraits<Eigen::Vector4f>::set(id, get_uniform_location<Eigen::Vector4f>(name), value);
 }
-void ShaderProgram::set_uniform(const std::string &name, const Eigen::Matrix2f &value)
+
+void ShaderProgram::set_uniform(const UniformName &name, const Eigen::Matrix2f &value)
 {
-    glUniformMatrix2fv(get_uniform_location(name), 1, GL_FALSE, value.data());
+    UniformTraits<Eigen::Matrix2f>::set(id, get_uniform_location<Eigen::Matrix2f>(name), value);
 }
-void ShaderProgram::set_uniform(const std::string &name, const Eigen::Matrix3f &value)
+
+void ShaderProgram::set_uniform(const UniformName &name, const Eigen::Matrix3f &value)
 {
-    glUniformMatrix3fv(get_uniform_location(name), 1, GL_FALSE, value.data());
+    UniformTraits<Eigen::Matrix3f>::set(id, get_uniform_location<Eigen::Matrix3f>(name), value);
 }
-void ShaderProgram::set_uniform(const std::string &name, const Eigen::Matrix4f &value)
+
+void ShaderProgram::set_uniform(const UniformName &name, const Eigen::Matrix4f &value)
 {
-    glUniformMatrix4fv(get_uniform_location(name), 1, GL_FALSE, value.data());
-}
\ No newline at end of file
+    UniformTraits<Eigen::Matrix4f>::set(id, get_uniform_location<Eigen::Matrix4f>(name), value);
+}
@@ -1,4 +1,5 @@
 #include "SkyboxPass.hpp"
+#include "GLState.hpp"
 
 #include <GL/glew.h>
 #include <GL/gl.h>
@@ -10,9 +11,9 @@ SkyboxPass::SkyboxPass(const std::string &cubemapPath)
     skyboxShader = std::unique_ptr<ShaderProgram>(new ShaderProgram({
         {
             ShaderType::Vertex,
-            R"(
+            std::string(R"(
             #version 460 core
-            uniform mat4 mvp;
+            )") + RenderingSystem::GLSL_CAMERA_BLOCK + R"(
 
             const float vertices[8 * 3] = float[](
                 -1.0, -1.0, -1.0, // 0
@@ -40,7 +41,7 @@ SkyboxPass::SkyboxPass(const std::string &cubemapPath)
                 int index = gl_VertexID;
                 vec3 position = vec3(vertices[index * 3], vertices[index * 3 + 1], vertices[index * 3 + 2]);
                 texCoords = position;
-                gl_Position = mvp * vec4(position, 1.0);
+                gl_Position = view_projection * vec4(position, 1.0);
             }
 
         )"
@@ -62,17 +63,20 @@ SkyboxPass::SkyboxPass(const std::string &cubemapPath)
         )"
         }
     }));
+
+    // the cubemap is always attached to texture unit 0
+    skyboxShader->uniform<int32_t>("skybox"_uniform).set(0);
 }
 
 struct temporary_set_depth_func_to_lequal
 {
     temporary_set_depth_func_to_lequal()
     {
-        glDepthFunc(GL_LEQUAL);
+        GLState::get_instance().set_depth_func(GL_LEQUAL);
     }
     ~temporary_set_depth_func_to_lequal()
     {
-        glDepthFunc(GL_LESS);
+        GLState::get_instance().set_depth_func(GL_LESS);
     }
 };
 
@@ -80,17 +84,8 @@ void SkyboxPass::execute()
 {
     temporary_set_depth_func_to_lequal tmp;
 
-    auto camera = get_rendering_system()->get_camera();
-
-    skyboxShader->use();
-
-    // set mvp matrix
-    Eigen::Matrix4f mvp = camera->get_projection() * camera->get_view();
-    skyboxShader->set_uniform("mvp", mvp);
-
     // using texture unit 0
     skybox->attach(0);
-    skyboxShader->set_uniform("skybox", 0);
 
     // draw skybox
     skyboxShader->run(36);
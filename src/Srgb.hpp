@@ -0,0 +1,56 @@
+#pragma once
+
+// internal to the engine : the srgb transfer functions shared by Color and ImageKernels
+
+#include <algorithm>
+#include <cmath>
+
+namespace srgb
+{
+    inline float to_linear(float value)
+    {
+        return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    inline float from_linear(float value)
+    {
+        return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+    }
+
+    /**
+     * the transfer functions sampled in [0, 1], read with sample() which interpolates linearly
+     */
+    struct Tables
+    {
+        static const int STEPS = 4096;
+        float byte_to_linear[256];
+        float to_linear[STEPS + 1];
+        float to_srgb[STEPS + 1];
+
+        Tables()
+        {
+            for (int i = 0; i < 256; i++)
+            {
+                byte_to_linear[i] = srgb::to_linear(i / 255.0f);
+            }
+            for (int i = 0; i <= STEPS; i++)
+            {
+                to_linear[i] = srgb::to_linear(float(i) / STEPS);
+                to_srgb[i] = srgb::from_linear(float(i) / STEPS);
+            }
+        }
+
+        static const Tables &get()
+        {
+            static Tables tables;
+            return tables;
+        }
+
+        static inline float sample(const float *table, float value)
+        {
+            float f = std::clamp(value, 0.0f, 1.0f) * STEPS;
+            int i = std::min(int(f), STEPS - 1);
+            return table[i] + (table[i + 1] - table[i]) * (f - i);
+        }
+    };
+}
@@ -0,0 +1,156 @@
+#include "StreamingBuffer.hpp"
+#include "GLState.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+static const GLbitfield MAPPING_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+StreamingRing::StreamingRing(size_t segment_size_, int segment_count_) : segment_size(segment_size_), segment_count(segment_count_)
+{
+    if (segment_count < 1)
+    {
+        throw std::invalid_argument("the streaming buffer needs at least one segment");
+    }
+}
+
+size_t StreamingRing::allocate(size_t size, size_t alignment)
+{
+    if (alignment == 0)
+    {
+        throw std::invalid_argument("the alignment of a streaming allocation cannot be 0");
+    }
+    // the alignment is required by the buffer bindings, so it applies to the offset in the buffer, not in the segment
+    size_t segment_start = current * segment_size;
+    size_t start = (segment_start + cursor + alignment - 1) / alignment * alignment;
+    if (start - segment_start + size > segment_size)
+    {
+        throw std::runtime_error("streaming buffer segment is full (" + std::to_string(segment_size) + " bytes)");
+    }
+    cursor = start - segment_start + size;
+    return start;
+}
+
+bool StreamingRing::next_segment()
+{
+    if (cursor == 0)
+    {
+        return false;
+    }
+    current = (current + 1) % segment_count;
+    cursor = 0;
+    return true;
+}
+
+int StreamingRing::get_current() const
+{
+    return current;
+}
+
+int StreamingRing::get_segment_count() const
+{
+    return segment_count;
+}
+
+size_t StreamingRing::get_segment_size() const
+{
+    return segment_size;
+}
+
+size_t StreamingRing::get_used_size() const
+{
+    return cursor;
+}
+
+StreamingBuffer::StreamingBuffer(size_t segment_size, int segment_count) : ring(segment_size, segment_count), segments(ring.get_segment_count())
+{
+    if (!GLEW_ARB_buffer_storage)
+    {
+        throw std::runtime_error("streaming buffers require GL_ARB_buffer_storage");
+    }
+    buffer = std::make_shared<VertexBuffer>();
+    buffer->size = segment_size * segment_count;
+    buffer->capacity = buffer->size;
+    GLState::get_instance().bind_buffer(GL_ARRAY_BUFFER, buffer->id);
+    glBufferStorage(GL_ARRAY_BUFFER, buffer->size, nullptr, MAPPING_FLAGS);
+    mapped = (uint8_t *)glMapBufferRange(GL_ARRAY_BUFFER, 0, buffer->size, MAPPING_FLAGS);
+    if (!mapped)
+    {
+        throw std::runtime_error("could not map the streaming buffer");
+    }
+}
+
+StreamingBuffer::~StreamingBuffer()
+{
+    for (auto &segment : segments)
+    {
+        if (segment.fence)
+        {
+            glDeleteSync((GLsync)segment.fence);
+        }
+    }
+    if (buffer)
+    {
+        GLState::get_instance().bind_buffer(GL_ARRAY_BUFFER, buffer->id);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+}
+
+VertexBufferRange StreamingBuffer::allocate(size_t size, size_t alignment)
+{
+    size_t start = ring.allocate(size, alignment);
+    return VertexBufferRange{buffer, start, size, mapped + start};
+}
+
+VertexBufferRange StreamingBuffer::write(const void *data, size_t size)
+{
+    auto range = allocate(size);
+    memcpy(range.data, data, size);
+    return range;
+}
+
+void StreamingBuffer::next_frame()
+{
+    int previous = ring.get_current();
+    if (!ring.next_segment())
+    {
+        return; // nothing written in this segment, it can be reused as is
+    }
+    segments[previous].fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    Segment &segment = segments[ring.get_current()];
+    if (segment.fence)
+    {
+        GLenum status = glClientWaitSync((GLsync)segment.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        {
+            stall_count++;
+            glClientWaitSync((GLsync)segment.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GLuint64(-1));
+        }
+        glDeleteSync((GLsync)segment.fence);
+        segment.fence = nullptr;
+    }
+}
+
+size_t StreamingBuffer::get_segment_size() const
+{
+    return ring.get_segment_size();
+}
+
+size_t StreamingBuffer::get_used_size() const
+{
+    return ring.get_used_size();
+}
+
+int StreamingBuffer::get_stall_count() const
+{
+    return stall_count;
+}
+
+std::shared_ptr<VertexBuffer> StreamingBuffer::get_buffer() const
+{
+    return buffer;
+}
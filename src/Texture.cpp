@@ -1,9 +1,10 @@
 #include "Texture.hpp"
+#include "GLState.hpp"
 
 #include <GL/glew.h>
 #include <GL/gl.h>
 
-static uint32_t get_format(int channels) {
+uint32_t Texture::get_pixel_format(int channels) {
         switch(channels) {
                 case 1: return GL_RED;
                 case 2: return GL_RG;
@@ -17,39 +18,147 @@ std::shared_ptr<Texture> Texture::load(const std::string& path) {
         return std::make_shared<Texture>(Image::load(path));
 }
 
-Texture::Texture(const Image &image) : dimensions(image.get_dimensions()), channels(image.get_channels()) {
+void Texture::upload(uint32_t target, const ConstImageView &view, int level) {
+        uint32_t format = get_pixel_format(view.get_channels());
+        int row_length = 0;
+        if(!view.is_contiguous()) {
+                if(view.get_stride() % view.get_channels() != 0) {
+                        // the rows cannot be described in pixels, fall back to a packed copy
+                        Image packed(view);
+                        upload(target, packed.view(), level);
+                        return;
+                }
+                row_length = view.get_stride() / view.get_channels();
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, row_length);
+        glTexImage2D(target, level, format, view.get_width(), view.get_height(), 0, format, GL_UNSIGNED_BYTE, view.get_data());
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+Texture::Texture(const Image &image) : Texture(image.view()) {
+}
+
+Texture::Texture(const ConstImageView &view) : Texture(view, {}) {
+}
 
-        uint32_t format = get_format(channels);
+Texture::Texture(const ConstImageView &view, const std::vector<Image> &mip_chain) : channels(view.get_channels()), dimensions(view.get_dimensions()) {
 
         glGenTextures(1, &id);
-        glBindTexture(GL_TEXTURE_2D, id);
+        GLState::get_instance().bind_texture(GL_TEXTURE_2D, id);
 
         // set the texture wrapping/filtering options (on the currently bound texture object)
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, dimensions.x(), dimensions.y(), 0, format, GL_UNSIGNED_BYTE, image.get_data());
+        upload(GL_TEXTURE_2D, view);
+        memory_size = view.get_size();
+        if(mip_chain.empty()) {
+                glGenerateMipmap(GL_TEXTURE_2D);
+                memory_size += memory_size / 3; // a full chain adds about a third
+        } else {
+                for(size_t level = 0; level < mip_chain.size(); level++) {
+                        upload(GL_TEXTURE_2D, mip_chain[level].view(), level + 1);
+                        memory_size += mip_chain[level].get_size();
+                }
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mip_chain.size());
+        }
+}
+
+Texture::Texture(const Eigen::Vector2i &dimensions_, int channels_) : channels(channels_), dimensions(dimensions_) {
+
+        uint32_t format = get_pixel_format(channels);
+
+        glGenTextures(1, &id);
+        GLState::get_instance().bind_texture(GL_TEXTURE_2D, id);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, dimensions.x(), dimensions.y(), 0, format, GL_UNSIGNED_BYTE, nullptr);
+        memory_size = size_t(dimensions.x()) * dimensions.y() * channels;
+}
+
+void Texture::generate_mipmaps() {
+        GLState::get_instance().bind_texture(GL_TEXTURE_2D, id);
         glGenerateMipmap(GL_TEXTURE_2D);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        memory_size = size_t(dimensions.x()) * dimensions.y() * channels * 4 / 3;
+}
+
+static uint32_t get_compressed_format(CompressedImage::Format format) {
+        switch(format) {
+                case CompressedImage::Format::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+                case CompressedImage::Format::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+                case CompressedImage::Format::BC4: return GL_COMPRESSED_RED_RGTC1;
+                case CompressedImage::Format::BC5: return GL_COMPRESSED_RG_RGTC2;
+                default: throw std::runtime_error("invalid compressed format");
+        }
+}
+
+Texture::Texture(const CompressedImage &image, const std::vector<CompressedImage> &mip_chain) : channels(image.get_channels()), dimensions(image.dimensions) {
+
+        if((image.format == CompressedImage::Format::BC1 || image.format == CompressedImage::Format::BC3) && !GLEW_EXT_texture_compression_s3tc) {
+                throw std::runtime_error("s3tc texture compression is not supported");
+        }
+        uint32_t format = get_compressed_format(image.format);
+
+        glGenTextures(1, &id);
+        GLState::get_instance().bind_texture(GL_TEXTURE_2D, id);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mip_chain.empty() ? GL_LINEAR : GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mip_chain.size());
+
+        auto upload_level = [&](int level, const CompressedImage &compressed) {
+                if(compressed.format != image.format) {
+                        GLState::get_instance().forget_texture(id);
+                        glDeleteTextures(1, &id);
+                        throw std::runtime_error("all mipmap levels must share the same compressed format");
+                }
+                glCompressedTexImage2D(GL_TEXTURE_2D, level, format, compressed.dimensions.x(), compressed.dimensions.y(), 0, compressed.data.size(), compressed.data.data());
+                memory_size += compressed.data.size();
+        };
+        upload_level(0, image);
+        for(size_t level = 0; level < mip_chain.size(); level++) {
+                upload_level(level + 1, mip_chain[level]);
+        }
 }
 
 void Texture::to_unit(uint32_t unit) {
-        glActiveTexture(GL_TEXTURE0 + unit);
-        glBindTexture(GL_TEXTURE_2D, id);
+        GLState::get_instance().bind_texture(unit, GL_TEXTURE_2D, id);
 }
 
 Eigen::Vector2i Texture::get_dimensions() const {
         return dimensions;
 }
 
+int Texture::get_channels() const {
+        return channels;
+}
+
+uint32_t Texture::get_id() const {
+        return id;
+}
+
+size_t Texture::get_memory_size() const {
+        return memory_size;
+}
+
 Image Texture::to_image() {
-        glBindTexture(GL_TEXTURE_2D, id);
+        GLState::get_instance().bind_texture(GL_TEXTURE_2D, id);
         Image image(dimensions.x(), dimensions.y(), channels);
-        uint32_t format = get_format(channels);
+        uint32_t format = get_pixel_format(channels);
         glGetTexImage(GL_TEXTURE_2D, 0, format, GL_UNSIGNED_BYTE, image.get_data());
         return image;
 }
 
 Texture::~Texture() {
+    GLState::get_instance().forget_texture(id);
     glDeleteTextures(1, &id);
 }	
\ No newline at end of file
@@ -0,0 +1,177 @@
+#include "TextureCache.hpp"
+#include "FileSystem.hpp"
+#include "Md5.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+TextureCache::Handle::Handle(TextureCache *cache_, std::shared_ptr<Slot> slot_) : cache(cache_), slot(slot_)
+{
+}
+
+std::shared_ptr<Texture> TextureCache::Handle::get() const
+{
+    if (!slot)
+    {
+        throw std::runtime_error("empty texture handle");
+    }
+    return cache->acquire(*slot);
+}
+
+bool TextureCache::Handle::is_resident() const
+{
+    return slot && slot->resident && slot->resident->loaded;
+}
+
+const std::string &TextureCache::Handle::get_uri() const
+{
+    return slot->uri;
+}
+
+static TextureCache::Upload upload_texture(const Blob &data)
+{
+    auto texture = std::make_shared<Texture>(Image::load(data));
+    return TextureCache::Upload{texture, texture->get_memory_size()};
+}
+
+TextureCache::TextureCache(size_t budget_, Factory factory_) : budget(budget_), factory(factory_ ? factory_ : upload_texture)
+{
+}
+
+TextureCache::~TextureCache()
+{
+    clear();
+}
+
+TextureCache &TextureCache::get_instance()
+{
+    // never destroyed : at exit the gl context is gone, the textures still resident are abandoned with it
+    static TextureCache *instance = new TextureCache();
+    return *instance;
+}
+
+TextureCache::Handle TextureCache::get(const std::string &uri)
+{
+    if (slots.size() + residents.size() >= collect_threshold)
+    {
+        collect();
+    }
+    auto &slot = slots[uri];
+    if (!slot)
+    {
+        slot = std::make_shared<Slot>();
+        slot->uri = uri;
+    }
+    return Handle(this, slot);
+}
+
+std::shared_ptr<Texture> TextureCache::acquire(Slot &slot)
+{
+    if (slot.resident && slot.resident->loaded)
+    {
+        touch(*slot.resident);
+        return slot.resident->texture;
+    }
+
+    Blob data = FileSystem::get_entry(slot.uri)->read();
+    std::string hash = Md5Digest::hexdigest(data.get_ptr(), data.get_size());
+
+    // another uri may have uploaded the same content
+    std::shared_ptr<Resident> &resident = residents[hash];
+    if (!resident)
+    {
+        resident = std::make_shared<Resident>(Resident{hash, nullptr, {}, 0, false, lru.end()});
+    }
+    slot.resident = resident;
+
+    if (!resident->loaded)
+    {
+        if (!resident->released.expired())
+        {
+            // a caller kept the texture since its eviction, uploading it again would duplicate it in video memory
+            resident->texture = resident->released.lock();
+        }
+        else
+        {
+            Upload upload = factory(data);
+            resident->texture = upload.texture;
+            resident->memory_size = upload.memory_size;
+        }
+        resident->released.reset();
+        resident->loaded = true;
+        usage += resident->memory_size;
+        resident->lru = lru.insert(lru.begin(), resident.get());
+        trim();
+    }
+    touch(*resident);
+    return resident->texture;
+}
+
+void TextureCache::touch(Resident &resident)
+{
+    lru.splice(lru.begin(), lru, resident.lru);
+}
+
+void TextureCache::evict(Resident &resident)
+{
+    usage -= resident.memory_size;
+    resident.released = resident.texture;
+    resident.texture.reset();
+    resident.loaded = false;
+    lru.erase(resident.lru);
+    resident.lru = lru.end();
+}
+
+void TextureCache::collect()
+{
+    for (auto it = slots.begin(); it != slots.end();)
+    {
+        it = it->second.use_count() == 1 ? slots.erase(it) : std::next(it);
+    }
+    for (auto it = residents.begin(); it != residents.end();)
+    {
+        const Resident &resident = *it->second;
+        bool unused = it->second.use_count() == 1 && !resident.loaded && resident.released.expired();
+        it = unused ? residents.erase(it) : std::next(it);
+    }
+    collect_threshold = std::max<size_t>(64, 2 * (slots.size() + residents.size()));
+}
+
+void TextureCache::set_budget(size_t budget_)
+{
+    budget = budget_;
+    trim();
+}
+
+size_t TextureCache::get_budget() const
+{
+    return budget;
+}
+
+size_t TextureCache::get_usage() const
+{
+    return usage;
+}
+
+size_t TextureCache::get_resident_count() const
+{
+    return lru.size();
+}
+
+void TextureCache::trim()
+{
+    // the most recently used texture is kept even if it exceeds the budget by itself
+    while (usage > budget && lru.size() > 1)
+    {
+        evict(*lru.back());
+    }
+}
+
+void TextureCache::clear()
+{
+    while (!lru.empty())
+    {
+        evict(*lru.back());
+    }
+    collect();
+}
@@ -0,0 +1,149 @@
+#include "TextureReadback.hpp"
+#include "GLState.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+TextureReadback::TextureReadback(int ring_size) : slots(ring_size)
+{
+    if (ring_size < 1)
+    {
+        throw std::invalid_argument("the readback ring needs at least one buffer");
+    }
+    for (auto &slot : slots)
+    {
+        glGenBuffers(1, &slot.buffer);
+    }
+}
+
+TextureReadback::~TextureReadback()
+{
+    for (auto &slot : slots)
+    {
+        if (slot.fence)
+        {
+            glDeleteSync((GLsync)slot.fence);
+            slot.promise.set_exception(std::make_exception_ptr(std::runtime_error("readback destroyed before completion")));
+        }
+        GLState::get_instance().forget_buffer(slot.buffer);
+        glDeleteBuffers(1, &slot.buffer);
+    }
+}
+
+TextureReadback::Slot &TextureReadback::acquire(size_t size)
+{
+    Slot *free = nullptr;
+    for (auto &slot : slots)
+    {
+        if (!slot.fence)
+        {
+            free = &slot;
+            break;
+        }
+    }
+    if (!free)
+    {
+        // the ring is full, the oldest readback has to complete now
+        free = in_flight.front();
+        glClientWaitSync((GLsync)free->fence, GL_SYNC_FLUSH_COMMANDS_BIT, GLuint64(-1));
+        finish(*free);
+    }
+    GLState::get_instance().bind_buffer(GL_PIXEL_PACK_BUFFER, free->buffer);
+    if (free->capacity < size)
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        free->capacity = size;
+    }
+    free->promise = std::promise<Image>();
+    return *free;
+}
+
+std::future<Image> TextureReadback::read(const Texture &texture)
+{
+    Eigen::Vector2i dimensions = texture.get_dimensions();
+    int channels = texture.get_channels();
+    Slot &slot = acquire(size_t(dimensions.x()) * dimensions.y() * channels);
+    slot.dimensions = dimensions;
+    slot.channels = channels;
+    slot.flip = false;
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    GLState::get_instance().bind_texture(GL_TEXTURE_2D, texture.get_id());
+    glGetTexImage(GL_TEXTURE_2D, 0, Texture::get_pixel_format(channels), GL_UNSIGNED_BYTE, nullptr);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    GLState::get_instance().bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    in_flight.push_back(&slot);
+    return slot.promise.get_future();
+}
+
+std::future<Image> TextureReadback::read_framebuffer(const Eigen::Vector2i &size, int channels)
+{
+    if (channels != 3 && channels != 4)
+    {
+        throw std::invalid_argument("framebuffer readbacks are rgb or rgba");
+    }
+    Slot &slot = acquire(size_t(size.x()) * size.y() * channels);
+    slot.dimensions = size;
+    slot.channels = channels;
+    slot.flip = true;
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, size.x(), size.y(), Texture::get_pixel_format(channels), GL_UNSIGNED_BYTE, nullptr);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    GLState::get_instance().bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    in_flight.push_back(&slot);
+    return slot.promise.get_future();
+}
+
+void TextureReadback::finish(Slot &slot)
+{
+    glDeleteSync((GLsync)slot.fence);
+    slot.fence = nullptr;
+    in_flight.erase(std::find(in_flight.begin(), in_flight.end(), &slot));
+
+    Image image(slot.dimensions.x(), slot.dimensions.y(), slot.channels);
+    GLState::get_instance().bind_buffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    const void *pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, image.get_size(), GL_MAP_READ_BIT);
+    if (!pixels)
+    {
+        GLState::get_instance().bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+        slot.promise.set_exception(std::make_exception_ptr(std::runtime_error("could not map the readback buffer")));
+        return;
+    }
+    memcpy(image.get_data(), pixels, image.get_size());
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    GLState::get_instance().bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (slot.flip)
+    {
+        image.flip_vertically();
+    }
+    slot.promise.set_value(std::move(image));
+}
+
+void TextureReadback::update()
+{
+    // the fences signal in order, so the oldest readbacks are checked first
+    while (!in_flight.empty())
+    {
+        Slot &slot = *in_flight.front();
+        GLenum status = glClientWaitSync((GLsync)slot.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        {
+            break;
+        }
+        finish(slot);
+    }
+}
+
+size_t TextureReadback::get_pending_count() const
+{
+    return in_flight.size();
+}
@@ -0,0 +1,160 @@
+#include "TextureStreamer.hpp"
+#include "ThreadPool.hpp"
+#include "GLState.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+static const GLbitfield MAPPING_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+TextureStreamer::TextureStreamer(size_t slot_size_, int slot_count) : slot_size(slot_size_), slots(slot_count), persistent(GLEW_ARB_buffer_storage)
+{
+    if (persistent)
+    {
+        for (auto &slot : slots)
+        {
+            glGenBuffers(1, &slot.buffer);
+            GLState::get_instance().bind_buffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+            glBufferStorage(GL_PIXEL_UNPACK_BUFFER, slot_size, nullptr, MAPPING_FLAGS);
+            slot.mapped = (uint8_t *)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, slot_size, MAPPING_FLAGS);
+        }
+        GLState::get_instance().bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    for (auto &slot : slots)
+    {
+        if (slot.copy.valid())
+        {
+            slot.copy.wait();
+        }
+        if (slot.fence)
+        {
+            glDeleteSync((GLsync)slot.fence);
+        }
+        if (slot.buffer)
+        {
+            GLState::get_instance().bind_buffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            GLState::get_instance().forget_buffer(slot.buffer);
+            glDeleteBuffers(1, &slot.buffer);
+        }
+    }
+    GLState::get_instance().bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+std::shared_ptr<Texture> TextureStreamer::upload(Image &&image, std::function<void(std::shared_ptr<Texture>)> on_complete)
+{
+    auto upload = std::make_shared<Upload>(Upload{std::make_shared<Texture>(image.get_dimensions(), image.get_channels()), std::move(image), 0, 0, std::move(on_complete)});
+    pending.push_back(upload);
+    running.push_back(upload);
+    return upload->texture;
+}
+
+int TextureStreamer::get_rows_per_chunk(const Upload &upload) const
+{
+    size_t row_size = size_t(upload.image.get_dimensions().x()) * upload.image.get_channels();
+    return int(std::max<size_t>(1, slot_size / std::max<size_t>(1, row_size)));
+}
+
+void TextureStreamer::complete_if_done(const std::shared_ptr<Upload> &upload)
+{
+    if (upload->rows_sent < upload->image.get_dimensions().y())
+    {
+        return;
+    }
+    upload->texture->generate_mipmaps();
+    running.erase(std::remove(running.begin(), running.end(), upload), running.end());
+    if (upload->on_complete)
+    {
+        upload->on_complete(upload->texture);
+    }
+}
+
+void TextureStreamer::update()
+{
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // buffers filled by the workers are sent, buffers read by the gpu are released
+    for (auto &slot : slots)
+    {
+        if (slot.state == SlotState::Copying && slot.copy.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            slot.copy.get();
+            auto upload = std::move(slot.upload);
+            Eigen::Vector2i size = upload->image.get_dimensions();
+            GLState::get_instance().bind_texture(GL_TEXTURE_2D, upload->texture->get_id());
+            GLState::get_instance().bind_buffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, slot.first_row, size.x(), slot.row_count, Texture::get_pixel_format(upload->image.get_channels()), GL_UNSIGNED_BYTE, nullptr);
+            slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            slot.state = SlotState::InFlight;
+            upload->rows_sent += slot.row_count;
+            complete_if_done(upload);
+        }
+        else if (slot.state == SlotState::InFlight)
+        {
+            GLenum status = glClientWaitSync((GLsync)slot.fence, 0, 0);
+            if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+            {
+                glDeleteSync((GLsync)slot.fence);
+                slot.fence = nullptr;
+                slot.state = SlotState::Free;
+            }
+        }
+    }
+    GLState::get_instance().bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    // every free buffer takes the next chunk, at most one chunk per buffer and per frame
+    for (auto &slot : slots)
+    {
+        if (pending.empty())
+        {
+            break;
+        }
+        if (slot.state != SlotState::Free)
+        {
+            continue;
+        }
+        auto upload = pending.front();
+        Eigen::Vector2i size = upload->image.get_dimensions();
+        size_t row_size = size_t(size.x()) * upload->image.get_channels();
+        int first_row = upload->next_row;
+        int row_count = std::min(get_rows_per_chunk(*upload), size.y() - first_row);
+        const uint8_t *rows = (const uint8_t *)upload->image.get_data() + first_row * row_size;
+        upload->next_row += row_count;
+        if (upload->next_row == size.y())
+        {
+            pending.pop_front();
+        }
+
+        if (!persistent || row_size > slot_size)
+        {
+            // no mapped buffer, or a row that does not fit : sent from the image memory
+            GLState::get_instance().bind_texture(GL_TEXTURE_2D, upload->texture->get_id());
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, first_row, size.x(), row_count, Texture::get_pixel_format(upload->image.get_channels()), GL_UNSIGNED_BYTE, rows);
+            upload->rows_sent += row_count;
+            complete_if_done(upload);
+            continue;
+        }
+
+        uint8_t *destination = slot.mapped;
+        size_t bytes = row_count * row_size;
+        slot.state = SlotState::Copying;
+        slot.upload = upload;
+        slot.first_row = first_row;
+        slot.row_count = row_count;
+        slot.copy = ThreadPool::get_default().submit([destination, rows, bytes]()
+                                                     { memcpy(destination, rows, bytes); });
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+size_t TextureStreamer::get_pending_count() const
+{
+    return running.size();
+}
@@ -0,0 +1,211 @@
+#include "UniformBuffer.hpp"
+#include "strutil.hpp"
+#include "GLState.hpp"
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+static std::map<std::string, uint32_t> block_bindings;
+
+// base alignment and size of a type in std140, matrices are arrays of column vectors
+struct Std140Info
+{
+    Std140Layout::Type type;
+    unsigned int alignment;
+    unsigned int size;
+    unsigned int columns;
+};
+
+static Std140Info get_info(const std::string &name)
+{
+    using Type = Std140Layout::Type;
+    static const std::map<std::string, Std140Info> infos = {
+        {"f", {Type::Float, 4, 4, 1}},
+        {"i", {Type::Int, 4, 4, 1}},
+        {"u", {Type::Uint, 4, 4, 1}},
+        {"v2", {Type::Vec2, 8, 8, 1}},
+        {"v3", {Type::Vec3, 16, 12, 1}},
+        {"v4", {Type::Vec4, 16, 16, 1}},
+        {"m2", {Type::Mat2, 16, 8, 2}},
+        {"m3", {Type::Mat3, 16, 12, 3}},
+        {"m4", {Type::Mat4, 16, 16, 4}},
+    };
+    auto it = infos.find(name);
+    if (it == infos.end())
+    {
+        throw std::invalid_argument("unknown std140 type : " + name);
+    }
+    return it->second;
+}
+
+static unsigned int align(unsigned int offset, unsigned int alignment)
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+Std140Layout Std140Layout::parse_format(const std::string &format)
+{
+    Std140Layout layout;
+    unsigned int offset = 0;
+    for (auto &attr : strutil::split(strutil::trim(format), " "))
+    {
+        if (attr.empty())
+        {
+            continue;
+        }
+        Member member;
+        std::string name = attr;
+        auto bracket = attr.find('[');
+        if (bracket != std::string::npos)
+        {
+            name = attr.substr(0, bracket);
+            member.count = std::stoi(attr.substr(bracket + 1));
+        }
+        Std140Info info = get_info(name);
+        member.type = info.type;
+
+        // array elements and matrix columns are padded to vec4
+        bool padded = bracket != std::string::npos || info.columns > 1;
+        member.offset = align(offset, padded ? 16 : info.alignment);
+        member.stride = padded ? info.columns * 16 : info.size;
+        unsigned int size = padded ? member.count * member.stride : info.size;
+        offset = member.offset + size;
+        layout.members.push_back(member);
+    }
+    layout.size = align(offset, 16);
+    return layout;
+}
+
+UniformBuffer::UniformBuffer(const std::string &format) : layout(Std140Layout::parse_format(format)), data(layout.size, 0), dirty_begin(layout.size)
+{
+    glGenBuffers(1, &id);
+    GLState::get_instance().bind_buffer(GL_UNIFORM_BUFFER, id);
+    glBufferData(GL_UNIFORM_BUFFER, layout.size, data.data(), GL_DYNAMIC_DRAW);
+}
+
+UniformBuffer::~UniformBuffer()
+{
+    GLState::get_instance().forget_buffer(id);
+    glDeleteBuffers(1, &id);
+}
+
+void UniformBuffer::write(int member, int element, Std140Layout::Type type, const void *value, size_t size)
+{
+    if (member < 0 || member >= (int)layout.members.size())
+    {
+        throw std::out_of_range("no member " + std::to_string(member) + " in the uniform block");
+    }
+    const Std140Layout::Member &m = layout.members[member];
+    if (m.type != type)
+    {
+        throw std::invalid_argument("wrong type for member " + std::to_string(member) + " of the uniform block");
+    }
+    if (element < 0 || element >= (int)m.count)
+    {
+        throw std::out_of_range("no element " + std::to_string(element) + " in member " + std::to_string(member) + " of the uniform block");
+    }
+    size_t offset = m.offset + size_t(element) * m.stride;
+    memcpy(data.data() + offset, value, size);
+    dirty_begin = std::min(dirty_begin, offset);
+    dirty_end = std::max(dirty_end, offset + size);
+}
+
+// matrix columns start on 16 bytes boundaries
+template <int N>
+static void write_columns(uint8_t *destination, const Eigen::Matrix<float, N, N> &value)
+{
+    for (int column = 0; column < N; column++)
+    {
+        memcpy(destination + column * 16, value.col(column).data(), N * sizeof(float));
+    }
+}
+
+void UniformBuffer::set(int member, float value, int element)
+{
+    write(member, element, Std140Layout::Type::Float, &value, sizeof(value));
+}
+
+void UniformBuffer::set(int member, int32_t value, int element)
+{
+    write(member, element, Std140Layout::Type::Int, &value, sizeof(value));
+}
+
+void UniformBuffer::set(int member, uint32_t value, int element)
+{
+    write(member, element, Std140Layout::Type::Uint, &value, sizeof(value));
+}
+
+void UniformBuffer::set(int member, const Eigen::Vector2f &value, int element)
+{
+    write(member, element, Std140Layout::Type::Vec2, value.data(), sizeof(float) * 2);
+}
+
+void UniformBuffer::set(int member, const Eigen::Vector3f &value, int element)
+{
+    write(member, element, Std140Layout::Type::Vec3, value.data(), sizeof(float) * 3);
+}
+
+void UniformBuffer::set(int member, const Eigen::Vector4f &value, int element)
+{
+    write(member, element, Std140Layout::Type::Vec4, value.data(), sizeof(float) * 4);
+}
+
+void UniformBuffer::set(int member, const Eigen::Matrix2f &value, int element)
+{
+    uint8_t columns[32] = {};
+    write_columns<2>(columns, value);
+    write(member, element, Std140Layout::Type::Mat2, columns, sizeof(columns));
+}
+
+void UniformBuffer::set(int member, const Eigen::Matrix3f &value, int element)
+{
+    uint8_t columns[48] = {};
+    write_columns<3>(columns, value);
+    write(member, element, Std140Layout::Type::Mat3, columns, sizeof(columns));
+}
+
+void UniformBuffer::set(int member, const Eigen::Matrix4f &value, int element)
+{
+    write(member, element, Std140Layout::Type::Mat4, value.data(), sizeof(float) * 16);
+}
+
+void UniformBuffer::upload()
+{
+    if (dirty_begin >= dirty_end)
+    {
+        return;
+    }
+    GLState::get_instance().bind_buffer(GL_UNIFORM_BUFFER, id);
+    glBufferSubData(GL_UNIFORM_BUFFER, dirty_begin, dirty_end - dirty_begin, data.data() + dirty_begin);
+    dirty_begin = data.size();
+    dirty_end = 0;
+}
+
+void UniformBuffer::bind(uint32_t binding)
+{
+    GLState::get_instance().bind_buffer_base(GL_UNIFORM_BUFFER, binding, id);
+}
+
+const Std140Layout &UniformBuffer::get_layout() const
+{
+    return layout;
+}
+
+uint32_t UniformBuffer::get_id() const
+{
+    return id;
+}
+
+void UniformBuffer::set_block_binding(const std::string &block, uint32_t binding)
+{
+    block_bindings[block] = binding;
+}
+
+const std::map<std::string, uint32_t> &UniformBuffer::get_block_bindings()
+{
+    return block_bindings;
+}
@@ -1,5 +1,6 @@
 #include "Logging.hpp"
 #include "VertexArray.hpp"
+#include "GLState.hpp"
 
 #include <GL/glew.h>
 #include <GL/gl.h>
@@ -9,18 +10,15 @@ VertexArray::VertexArray()
     glGenVertexArrays(1, &id);
 }
 
-VertexArray::VertexArray(std::shared_ptr<ShaderProgram> shader_program)
+VertexArray::VertexArray(std::shared_ptr<ShaderProgram> shader_program) : VertexArray()
 {
     this->shader_program = shader_program;
 }
 
 VertexArray::~VertexArray()
 {
+    GLState::get_instance().forget_vertex_array(id);
     glDeleteVertexArrays(1, &id);
-    if(ebo_id != 0)
-    {
-        glDeleteBuffers(1, &ebo_id);
-    }
 }
 
 void VertexArray::set_program(std::shared_ptr<ShaderProgram> shader_program)
@@ -34,7 +32,6 @@ void VertexArray::set_program(const std::string &vertex_shader, const std::strin
 
 std::shared_ptr<ShaderProgram> VertexArray::get_shader_program()
 {
-    shader_program->use();
     return shader_program;
 }
 
@@ -45,35 +42,32 @@ void VertexArray::bind_buffer(int location, const std::string &format, const std
 
 void VertexArray::bind_buffer(int location, const std::vector<Eigen::Vector3f> &buffer) {
     auto vertex_buffer = std::make_shared<VertexBuffer>(buffer);
-    bind_buffer(location, "f3", vertex_buffer);
+    bind_buffer(location, "v3", vertex_buffer);
 }
 
-void VertexArray::bind_buffer(int location, const std::string &format, std::shared_ptr<VertexBuffer> buffer, int divisor)
+void VertexArray::set_attribute(int location, const VertexStructure &vs, const VertexBuffer &buffer, size_t offset, int divisor)
 {
-
     if (location == 0)
     {
         assert(divisor == 0 && "divisor is forbidden for location 0 !");
     }
 
-    auto vs = VertexStructure::parse_format(format);
-
     // bind the vao
-    glBindVertexArray(id);
+    GLState::get_instance().bind_vertex_array(id);
 
     // bind the buffer
-    glBindBuffer(GL_ARRAY_BUFFER, buffer->id);
+    GLState::get_instance().bind_buffer(GL_ARRAY_BUFFER, buffer.id);
 
     // set the attribute
     // note : as we have sizes in bytes, we use GL_BYTE as the type even for floats
     // note : the pointer parameter is the offset in bytes from the beginning of the buffer, and not a real pointer
 
-    void *pOffset = reinterpret_cast<void *>((uint64_t)vs.offset); // opengl is an old api made with 32 bits in mind, so we have to cast to uint64_t to avoid warnings
+    void *pOffset = reinterpret_cast<void *>((uint64_t)(offset + vs.offset)); // opengl is an old api made with 32 bits in mind, so we have to cast to uint64_t to avoid warnings
 
 //    LOG(INFO) << "glVertexAttribPointer(" << location << ", " << vs.components_count << ", " << vs.gl_type << ", "
 //              << "GL_FALSE"
 //              << ", " << vs.stride << ", " << pOffset << ")";
-    glVertexAttribPointer(location, vs.components_count, vs.gl_type, GL_FALSE, vs.stride, pOffset);
+    glVertexAttribPointer(location, vs.components_count, vs.gl_type, vs.normalized ? GL_TRUE : GL_FALSE, vs.stride, pOffset);
 
     // a value of 0 means that the attribute is not instanced
     instanced = divisor != 0;
@@ -81,6 +75,12 @@ void VertexArray::bind_buffer(int location, const std::string &format, std::shar
 
     // enable the attribute
     glEnableVertexAttribArray(location);
+}
+
+void VertexArray::bind_buffer(int location, const std::string &format, std::shared_ptr<VertexBuffer> buffer, int divisor)
+{
+    auto vs = VertexStructure::parse_format(format);
+    set_attribute(location, vs, *buffer, 0, divisor);
 
     if (count == -1)
     {
@@ -95,27 +95,40 @@ void VertexArray::bind_buffer(int location, const std::string &format, std::shar
     buffers[location] = buffer;
 }
 
+void VertexArray::bind_buffer(int location, const std::string &format, const VertexBufferRange &range, int divisor)
+{
+    auto vs = VertexStructure::parse_format(format);
+    set_attribute(location, vs, *range.buffer, range.offset, divisor);
+
+    // dynamic geometry changes its number of vertices at each update
+    if (divisor == 0 && !ebo)
+    {
+        count = range.size / vs.stride;
+    }
+    buffers[location] = range.buffer;
+}
+
 void VertexArray::unbind_buffer(int location)
 {
     glDisableVertexArrayAttrib(id, location);
 }
 
 void VertexArray::set_ebo(const std::vector<uint32_t> &indices)
+{
+    set_ebo(std::make_shared<VertexBuffer>(indices));
+}
+
+void VertexArray::set_ebo(std::shared_ptr<VertexBuffer> indices)
 {
     // bind the vao
-    glBindVertexArray(id);
-    
-    // create the ebo if it does not exist
-    if(ebo_id == 0) {
-        glGenBuffers(1, &ebo_id);
-    }
+    GLState::get_instance().bind_vertex_array(id);
+
+    // bind the ebo, the binding is part of the vao state
+    GLState::get_instance().bind_buffer(GL_ELEMENT_ARRAY_BUFFER, indices->id);
+    ebo = indices;
 
-    // bind the ebo
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_id);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_STATIC_DRAW);
-    
     // set the count
-    count = indices.size();
+    count = indices->get_size() / sizeof(uint32_t);
     LOG(INFO) << "vertices = " << count;
 }
 
@@ -124,7 +137,7 @@ size_t VertexArray::get_count() const
     return count;
 }
 
-void VertexArray::render()
+void VertexArray::bind()
 {
     if (shader_program)
     {
@@ -135,12 +148,27 @@ void VertexArray::render()
         throw std::runtime_error("no shader program set !");
     }
 
-    glBindVertexArray(id);
+    // edits made since the last draw are uploaded now, coalesced
+    for (auto &[location, buffer] : buffers)
+    {
+        buffer->flush();
+    }
+    if (ebo)
+    {
+        ebo->flush();
+    }
+
+    GLState::get_instance().bind_vertex_array(id);
+}
+
+void VertexArray::render()
+{
+    bind();
 
     if (!instanced)
     {
 
-        if (ebo_id != 0)
+        if (ebo)
         {
             glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr);
         }
@@ -151,7 +179,7 @@ void VertexArray::render()
     }
     else
     {
-        if (ebo_id != 0)
+        if (ebo)
         {
             glDrawElementsInstanced(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr, count);
         }
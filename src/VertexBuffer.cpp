@@ -1,14 +1,18 @@
 #include "VertexBuffer.hpp"
 #include "strutil.hpp"
+#include "GLState.hpp"
 #include <GL/glew.h>
 #include <GL/gl.h>
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <regex>
+#include <stdexcept>
 #include <utility>
 
 static std::pair<std::string, int> parse_attr(const std::string &attr)
 {
-    static std::regex re("^\\[(\\d+)\\]$");
+    static std::regex re("\\[(\\d+)\\]$");
     std::smatch match;
     if (std::regex_search(attr, match, re))
     {
@@ -25,7 +29,7 @@ VertexStructure VertexStructure::parse_format(const std::string &format_)
 {
     std::string format(format_); // copy because we will modify it
     assert(format.size() > 0);
-    VertexStructure vs{0, 0, 0, 0};
+    VertexStructure vs;
 
     // offset
     if (format[0] == '(')
@@ -54,6 +58,11 @@ VertexStructure VertexStructure::parse_format(const std::string &format_)
     for (auto &attr : strutil::split(format, " "))
     {
         auto [attr_name, attr_multiplier] = parse_attr(attr);
+        if (attr_name.size() > 1 && attr_name[1] == 'n')
+        {
+            assert(strchr("iubcws", attr_name[0]) && "only integer types can be normalized");
+            vs.normalized = true;
+        }
         // (f for float, i for int, u for unsigned int, b for byte, v2 for 2 floats, v3 for 3 floats, v4 for 4 floats, m2 for 2x2 matrix, m3 for 3x3 matrix, m4 for 4x4 matrix)
         switch (attr_name[0])
         {
@@ -77,6 +86,21 @@ VertexStructure VertexStructure::parse_format(const std::string &format_)
             vs.components_count += attr_multiplier;
             vs.gl_type = GL_UNSIGNED_BYTE;
             break;
+        case 'c':
+            vs.size += 1 * attr_multiplier;
+            vs.components_count += attr_multiplier;
+            vs.gl_type = GL_BYTE;
+            break;
+        case 'w':
+            vs.size += 2 * attr_multiplier;
+            vs.components_count += attr_multiplier;
+            vs.gl_type = GL_UNSIGNED_SHORT;
+            break;
+        case 's':
+            vs.size += 2 * attr_multiplier;
+            vs.components_count += attr_multiplier;
+            vs.gl_type = GL_SHORT;
+            break;
         case 'v':
             vs.gl_type = GL_FLOAT;
             switch (attr_name[1])
@@ -135,7 +159,7 @@ VertexStructure VertexStructure::parse_format(const std::string &format_)
 
 bool VertexStructure::operator==(const VertexStructure &other) const
 {
-    return offset == other.offset && size == other.size && components_count == other.components_count && stride == other.stride && gl_type == other.gl_type;
+    return offset == other.offset && size == other.size && components_count == other.components_count && stride == other.stride && gl_type == other.gl_type && normalized == other.normalized;
 }
 
 bool VertexStructure::operator!=(const VertexStructure &other) const
@@ -153,7 +177,78 @@ namespace std
 {
     string to_string(const VertexStructure &vs)
     {
-        return "VertexStructure(offset=" + std::to_string(vs.offset) + ", size=" + std::to_string(vs.size) + ", components_count=" + std::to_string(vs.components_count) + ", stride=" + std::to_string(vs.stride) + ", gl_type=" + std::to_string(vs.gl_type) + ")";
+        return "VertexStructure(offset=" + std::to_string(vs.offset) + ", size=" + std::to_string(vs.size) + ", components_count=" + std::to_string(vs.components_count) + ", stride=" + std::to_string(vs.stride) + ", gl_type=" + std::to_string(vs.gl_type) + ", normalized=" + (vs.normalized ? "true" : "false") + ")";
+    }
+}
+
+void BufferEdits::add(size_t offset, const void *data, size_t size)
+{
+    if (size == 0)
+    {
+        return;
+    }
+    size_t begin = offset;
+    size_t end = offset + size;
+
+    // the first range touching the edit may start before it
+    auto first = ranges.upper_bound(begin);
+    if (first != ranges.begin() && std::prev(first)->first + std::prev(first)->second.size() >= begin)
+    {
+        --first;
+    }
+    auto last = first;
+    while (last != ranges.end() && last->first <= end)
+    {
+        begin = std::min(begin, last->first);
+        end = std::max(end, last->first + last->second.size());
+        ++last;
+    }
+
+    std::vector<uint8_t> merged(end - begin);
+    for (auto it = first; it != last; ++it)
+    {
+        memcpy(merged.data() + (it->first - begin), it->second.data(), it->second.size());
+    }
+    memcpy(merged.data() + (offset - begin), data, size);
+    ranges.erase(first, last);
+    ranges.emplace(begin, std::move(merged));
+}
+
+const std::map<size_t, std::vector<uint8_t>> &BufferEdits::get_ranges() const
+{
+    return ranges;
+}
+
+size_t BufferEdits::get_size() const
+{
+    size_t size = 0;
+    for (auto &[offset, bytes] : ranges)
+    {
+        size += bytes.size();
+    }
+    return size;
+}
+
+bool BufferEdits::empty() const
+{
+    return ranges.empty();
+}
+
+void BufferEdits::clear()
+{
+    ranges.clear();
+}
+
+static GLenum get_gl_usage(BufferUsage usage)
+{
+    switch (usage)
+    {
+    case BufferUsage::Dynamic:
+        return GL_DYNAMIC_DRAW;
+    case BufferUsage::Stream:
+        return GL_STREAM_DRAW;
+    default:
+        return GL_STATIC_DRAW;
     }
 }
 
@@ -162,6 +257,11 @@ VertexBuffer::VertexBuffer()
     glGenBuffers(1, &id);
 }
 
+VertexBuffer::VertexBuffer(BufferUsage usage_) : VertexBuffer()
+{
+    usage = usage_;
+}
+
 VertexBuffer::VertexBuffer(const void *data, unsigned int size) : VertexBuffer()
 {
     set_data(data, size);
@@ -184,23 +284,102 @@ VertexBuffer::VertexBuffer(const std::vector<uint32_t> &data) : VertexBuffer()
 VertexBuffer::VertexBuffer(VertexBuffer &&buffer)
 {
     id = buffer.id;
+    ebo = buffer.ebo;
     size = buffer.size;
+    capacity = buffer.capacity;
+    usage = buffer.usage;
+    edits = std::move(buffer.edits);
     buffer.id = 0;
 }
 
 VertexBuffer::~VertexBuffer()
 {
+    GLState::get_instance().forget_buffer(id);
     glDeleteBuffers(1, &id);
 }
 
 void VertexBuffer::set_data(const void *data, unsigned int size)
 {
-    glBindBuffer(GL_ARRAY_BUFFER, id);
-    glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+    GLState::get_instance().bind_buffer(GL_ARRAY_BUFFER, id);
+    edits.clear();
+    if (size > capacity)
+    {
+        capacity = usage == BufferUsage::Static ? size : std::max(size, capacity + capacity / 2);
+        glBufferData(GL_ARRAY_BUFFER, capacity, capacity == size ? data : nullptr, get_gl_usage(usage));
+        if (capacity != size)
+        {
+            glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
+        }
+    }
+    else
+    {
+        if (usage == BufferUsage::Stream)
+        {
+            // orphan the storage, so the driver does not wait for draws still reading the previous content
+            glBufferData(GL_ARRAY_BUFFER, capacity, nullptr, get_gl_usage(usage));
+        }
+        glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
+    }
     this->size = size;
 }
 
+void VertexBuffer::update(unsigned int offset, const void *data, unsigned int size)
+{
+    if (size_t(offset) + size > this->size)
+    {
+        throw std::out_of_range("buffer update past the end (" + std::to_string(offset + size) + " > " + std::to_string(this->size) + ")");
+    }
+    GLState::get_instance().bind_buffer(GL_ARRAY_BUFFER, id);
+    glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+}
+
+void VertexBuffer::edit(unsigned int offset, const void *data, unsigned int size)
+{
+    if (size_t(offset) + size > this->size)
+    {
+        throw std::out_of_range("buffer edit past the end (" + std::to_string(offset + size) + " > " + std::to_string(this->size) + ")");
+    }
+    edits.add(offset, data, size);
+}
+
+size_t VertexBuffer::flush()
+{
+    if (edits.empty())
+    {
+        return 0;
+    }
+    GLState::get_instance().bind_buffer(GL_ARRAY_BUFFER, id);
+    size_t uploaded = 0;
+    for (auto &[offset, bytes] : edits.get_ranges())
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, offset, bytes.size(), bytes.data());
+        uploaded += bytes.size();
+    }
+    edits.clear();
+    return uploaded;
+}
+
+bool VertexBuffer::has_pending_edits() const
+{
+    return !edits.empty();
+}
+
+void VertexBuffer::set_usage(BufferUsage usage_)
+{
+    usage = usage_;
+}
+
+BufferUsage VertexBuffer::get_usage() const
+{
+    return usage;
+}
+
 unsigned int VertexBuffer::get_size() const
 {
     return size;
 }
+
+unsigned int VertexBuffer::get_capacity() const
+{
+    return capacity;
+}
@@ -7,11 +7,91 @@
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
 
+#ifdef ZENGINE_HAS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
 #include <map>
 #include <stdexcept>
 
 static bool glew_inited = false;
 
+struct Window::Headless
+{
+    Eigen::Vector2i dimensions;
+    GLuint framebuffer = 0;
+    GLuint renderbuffers[2] = {0, 0}; // color, depth + stencil
+#ifdef ZENGINE_HAS_EGL
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+    EGLSurface surface = EGL_NO_SURFACE;
+#endif
+
+    /**
+     * @brief destroys what has been created so far, the gl objects need the context to still be current
+     */
+    void release();
+};
+
+void Window::Headless::release()
+{
+    if (framebuffer)
+    {
+        glDeleteFramebuffers(1, &framebuffer);
+        framebuffer = 0;
+    }
+    if (renderbuffers[0])
+    {
+        glDeleteRenderbuffers(2, renderbuffers);
+        renderbuffers[0] = renderbuffers[1] = 0;
+    }
+#ifdef ZENGINE_HAS_EGL
+    if (display == EGL_NO_DISPLAY)
+    {
+        return;
+    }
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (surface != EGL_NO_SURFACE)
+    {
+        eglDestroySurface(display, surface);
+        surface = EGL_NO_SURFACE;
+    }
+    if (context != EGL_NO_CONTEXT)
+    {
+        eglDestroyContext(display, context);
+        context = EGL_NO_CONTEXT;
+    }
+    eglTerminate(display);
+    display = EGL_NO_DISPLAY;
+#endif
+}
+
+// GLEW can be inited once we have a GL context
+static void init_glew()
+{
+    if (glew_inited)
+    {
+        return;
+    }
+    glewExperimental = true;
+    GLenum err = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    // a GLX build of GLEW complains without X display, but the EGL context functions are loaded anyway
+    if (err == GLEW_ERROR_NO_GLX_DISPLAY)
+    {
+        err = GLEW_OK;
+    }
+#endif
+    if (err != GLEW_OK)
+    {
+        std::string msg("GLEW library intialization failed : ");
+        msg += std::string((char *)glewGetErrorString(err));
+        throw std::runtime_error(msg);
+    }
+    glew_inited = true;
+}
+
 static std::map<GLFWwindow *, Window *> window_map;
 
 static void error_callback(int error, const char *description)
@@ -59,29 +139,137 @@ Window::Window(const std::string &title, int width, int height, bool fullscreen)
 
     glfwMakeContextCurrent((GLFWwindow *)handle);
 
-    // GLEW can be inited once we have a GL context
-    if (!glew_inited)
+    init_glew();
+
+    // set up callbacks
+    glfwSetFramebufferSizeCallback((GLFWwindow *)handle, resize_callback);
+}
+
+#ifdef ZENGINE_HAS_EGL
+static EGLDisplay get_headless_display()
+{
+    // mesa can render without any display server (surfaceless platform), otherwise use the default display
+    auto get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    const char *extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (get_platform_display && extensions && std::string(extensions).find("EGL_MESA_platform_surfaceless") != std::string::npos)
     {
-        glewExperimental = true;
-        GLenum err = glewInit();
-        if (err != GLEW_OK)
+        EGLDisplay display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr))
         {
-            std::string msg("GLEW library intialization failed : ");
-            msg += std::string((char *)glewGetErrorString(err));
-            throw std::runtime_error(msg);
+            return display;
         }
-        else
+    }
+    EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr))
+    {
+        throw std::runtime_error("EGL initialization failed");
+    }
+    return display;
+}
+#endif
+
+Window::Window(int width, int height) : headless(std::make_unique<Headless>())
+{
+#ifdef ZENGINE_HAS_EGL
+    headless->dimensions = Eigen::Vector2i(width, height);
+    EGLDisplay display = headless->display = get_headless_display();
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        headless->release();
+        throw std::runtime_error("EGL does not support desktop OpenGL");
+    }
+
+    // the surfaceless platform may expose no configuration at all, the context is then created without one
+    const EGLint config_attributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_NONE};
+    EGLConfig config = EGL_NO_CONFIG_KHR;
+    EGLint config_count = 0;
+    if (!eglChooseConfig(display, config_attributes, &config, 1, &config_count) || config_count == 0)
+    {
+        config = EGL_NO_CONFIG_KHR;
+    }
+
+    // same version as the visible windows, or 4.5 (llvmpipe stops there), older versions cannot run the engine
+    for (auto [major, minor] : {std::pair(4, 6), std::pair(4, 5)})
+    {
+        const EGLint context_attributes[] = {EGL_CONTEXT_MAJOR_VERSION, major, EGL_CONTEXT_MINOR_VERSION, minor, EGL_NONE};
+        headless->context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attributes);
+        if (headless->context != EGL_NO_CONTEXT)
         {
-            glew_inited = true;
+            break;
         }
     }
+    if (headless->context == EGL_NO_CONTEXT)
+    {
+        headless->release();
+        throw std::runtime_error("EGL context creation failed");
+    }
 
-    // set up callbacks
-    glfwSetFramebufferSizeCallback((GLFWwindow *)handle, resize_callback);
+    // the frames go to a framebuffer object, a surface is only needed when surfaceless contexts are not supported
+    if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, headless->context))
+    {
+        const EGLint surface_attributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+        if (config != EGL_NO_CONFIG_KHR)
+        {
+            headless->surface = eglCreatePbufferSurface(display, config, surface_attributes);
+        }
+        if (headless->surface == EGL_NO_SURFACE || !eglMakeCurrent(display, headless->surface, headless->surface, headless->context))
+        {
+            headless->release();
+            throw std::runtime_error("could not make the EGL context current");
+        }
+    }
+
+    try
+    {
+        init_glew();
+    }
+    catch (...)
+    {
+        headless->release();
+        throw;
+    }
+
+    glGenRenderbuffers(2, headless->renderbuffers);
+    glBindRenderbuffer(GL_RENDERBUFFER, headless->renderbuffers[0]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, headless->renderbuffers[1]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &headless->framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, headless->framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, headless->renderbuffers[0]);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, headless->renderbuffers[1]);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        headless->release();
+        throw std::runtime_error("incomplete headless framebuffer");
+    }
+    glViewport(0, 0, width, height);
+    glScissor(0, 0, width, height);
+#else
+    (void)width;
+    (void)height;
+    throw std::runtime_error("headless rendering requires EGL, which was not found at build time");
+#endif
+}
+
+std::unique_ptr<Window> Window::create_headless(int width, int height)
+{
+    return std::unique_ptr<Window>(new Window(width, height));
 }
 
 Window::~Window()
 {
+    if (headless)
+    {
+        headless->release();
+        return;
+    }
     glfwSetFramebufferSizeCallback((GLFWwindow *)handle, nullptr);
     glfwDestroyWindow((GLFWwindow *)handle);
     window_map.erase((GLFWwindow *)handle);
@@ -93,7 +281,37 @@ Window::~Window()
 
 Eigen::Vector2i Window::get_dimensions() const
 {
+    if (headless)
+    {
+        return headless->dimensions;
+    }
     int width, height;
     glfwGetFramebufferSize((GLFWwindow *)handle, &width, &height);
     return Eigen::Vector2i(width, height);
+}
+
+bool Window::is_headless() const
+{
+    return headless != nullptr;
+}
+
+bool Window::should_close() const
+{
+    return !headless && glfwWindowShouldClose((GLFWwindow *)handle);
+}
+
+void Window::present()
+{
+    if (headless)
+    {
+        glFinish();
+        return;
+    }
+    glfwSwapBuffers((GLFWwindow *)handle);
+    glfwPollEvents();
+}
+
+uint32_t Window::get_framebuffer() const
+{
+    return headless ? headless->framebuffer : 0;
 }
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+// images shared by the tests
+
+#include "Image.hpp"
+
+/**
+ * @brief channel c of the pixel (x, y) in make_gradient(width, ...) : smooth horizontally, so it compresses well
+ */
+inline uint8_t gradient_value(int x, int y, int c, int width)
+{
+    return uint8_t((x * 255 / width + y * 3 + c * 50) % 256);
+}
+
+inline Image make_gradient(int width, int height, int channels)
+{
+    Image image(width, height, channels);
+    ImageView view = image.view();
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            for (int c = 0; c < channels; c++)
+            {
+                view.get_pixel(x, y)[c] = gradient_value(x, y, c, width);
+            }
+        }
+    }
+    return image;
+}
@@ -0,0 +1,87 @@
+#include <catch2/catch_test_macros.hpp>
+#include "Color.hpp"
+
+#include <cmath>
+#include <vector>
+
+TEST_CASE("Color batch conversions", "[Color]")
+{
+    SECTION("rgba8 round trip")
+    {
+        std::vector<uint8_t> bytes(256 * 4);
+        for (size_t i = 0; i < bytes.size(); i++)
+        {
+            bytes[i] = uint8_t(i / 4);
+        }
+        std::vector<Eigen::Vector4f> colors(256);
+        std::vector<uint8_t> back(bytes.size());
+        for (bool srgb : {false, true})
+        {
+            Color::rgba8_to_floats(bytes, colors, srgb);
+            Color::floats_to_rgba8(colors, back, srgb);
+            REQUIRE(back == bytes);
+        }
+        REQUIRE(std::abs(colors[128].x() - 0.2158605f) < 1e-4f); // srgb 128 is ~21.6% linear
+        REQUIRE(colors[128].w() == 128 / 255.0f);
+    }
+
+    SECTION("hsl matches the single color conversions")
+    {
+        std::vector<Eigen::Vector3f> hsl;
+        for (float h = 0.0f; h < 360.0f; h += 7.5f)
+        {
+            hsl.emplace_back(h, 0.7f, 0.4f);
+        }
+        std::vector<Eigen::Vector4f> rgb(hsl.size());
+        Color::hsl_to_rgb(hsl, rgb);
+        std::vector<Eigen::Vector3f> back(hsl.size());
+        Color::rgb_to_hsl(rgb, back);
+        for (size_t i = 0; i < hsl.size(); i++)
+        {
+            REQUIRE((rgb[i] - Color::hsl_to_rgb(hsl[i])).norm() < 1e-5f);
+            REQUIRE((back[i] - Color::rgb_to_hsl(rgb[i])).norm() < 1e-3f);
+            REQUIRE((back[i] - hsl[i]).norm() < 1e-3f);
+        }
+    }
+
+    SECTION("premultiplied alpha")
+    {
+        std::vector<uint8_t> bytes = {200, 100, 50, 128, 10, 20, 30, 0};
+        Color::premultiply_alpha(std::span<uint8_t>(bytes));
+        REQUIRE(bytes == std::vector<uint8_t>{100, 50, 25, 128, 0, 0, 0, 0});
+        Color::unpremultiply_alpha(std::span<uint8_t>(bytes));
+        REQUIRE(bytes == std::vector<uint8_t>{199, 100, 50, 128, 0, 0, 0, 0});
+
+        std::vector<Eigen::Vector4f> colors = {{1.0f, 0.5f, 0.25f, 0.5f}};
+        Color::premultiply_alpha(std::span<Eigen::Vector4f>(colors));
+        REQUIRE(colors[0] == Eigen::Vector4f(0.5f, 0.25f, 0.125f, 0.5f));
+        Color::unpremultiply_alpha(std::span<Eigen::Vector4f>(colors));
+        REQUIRE(colors[0] == Eigen::Vector4f(1.0f, 0.5f, 0.25f, 0.5f));
+    }
+}
+
+TEST_CASE("Color names", "[Color]")
+{
+    static_assert(Color::rgba32_for_name("cornflowerblue") == 0x6495EDFFu);
+    static_assert(!Color::rgba32_for_name("notacolor"));
+
+    SECTION("every name resolves to its own entry")
+    {
+        for (auto &entry : colornames::entries)
+        {
+            REQUIRE(colornames::find(entry.name) == &entry);
+        }
+    }
+
+    SECTION("for_name")
+    {
+        REQUIRE(Color::for_name("Light Sky Blue") == Color::for_name("lightskyblue"));
+        REQUIRE(Color::for_name("navy") == Eigen::Vector4f(0.0f, 0.0f, 128 / 255.0f, 1.0f));
+        REQUIRE(Color::for_name("#FF800040") == Eigen::Vector4f(1.0f, 128 / 255.0f, 0.0f, 64 / 255.0f));
+        REQUIRE(Color::for_name("rgb(255, 0,51)") == Eigen::Vector4f(1.0f, 0.0f, 0.2f, 1.0f));
+        REQUIRE((Color::for_name("hsl(120deg, 100%, 25%)") - Eigen::Vector4f(0.0f, 0.5f, 0.0f, 1.0f)).norm() < 1e-5f);
+        REQUIRE_THROWS_AS(Color::for_name("#12345"), std::runtime_error);
+        REQUIRE_THROWS_AS(Color::for_name("rgb(1, 2)"), std::runtime_error);
+        REQUIRE_THROWS_AS(Color::for_name("blu"), std::runtime_error);
+    }
+}
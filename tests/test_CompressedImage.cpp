@@ -0,0 +1,106 @@
+#include <catch2/catch_test_macros.hpp>
+#include "CompressedImage.hpp"
+#include "FileSystem.hpp"
+#include "TestImages.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+
+static double mean_error(const Image &a, const Image &b, int channels)
+{
+    double total = 0.0;
+    size_t count = size_t(a.get_dimensions().prod());
+    for (size_t i = 0; i < count; i++)
+    {
+        for (int c = 0; c < channels; c++)
+        {
+            total += std::abs(int(((uint8_t *)a.get_data())[i * a.get_channels() + c]) - int(((uint8_t *)b.get_data())[i * b.get_channels() + c]));
+        }
+    }
+    return total / (count * channels);
+}
+
+TEST_CASE("CompressedImage", "[CompressedImage]")
+{
+    SECTION("encode and decode")
+    {
+        for (int channels = 1; channels <= 4; channels++)
+        {
+            Image image = make_gradient(30, 18, channels);
+            CompressedImage compressed = CompressedImage::encode(image.view());
+            REQUIRE(compressed.format == CompressedImage::get_default_format(channels));
+            REQUIRE(compressed.data.size() == 8 * 5 * compressed.get_block_size());
+
+            Image decoded = compressed.decode();
+            REQUIRE(decoded.get_dimensions() == image.get_dimensions());
+            REQUIRE(decoded.get_channels() == channels);
+            REQUIRE(mean_error(image, decoded, channels) < 4.0);
+        }
+    }
+
+    SECTION("uniform blocks are exact")
+    {
+        Image image(4, 4, 4);
+        for (int i = 0; i < 16; i++)
+        {
+            uint8_t *pixel = (uint8_t *)image.get_data() + i * 4;
+            pixel[0] = 255;
+            pixel[1] = 0;
+            pixel[2] = 0;
+            pixel[3] = 128;
+        }
+        Image decoded = CompressedImage::encode(image.view(), CompressedImage::Format::BC3).decode();
+        REQUIRE(mean_error(image, decoded, 4) == 0.0);
+    }
+
+    SECTION("bc3 color blocks always use 4 colors")
+    {
+        // c0 = black <= c1 = white, every index is 3 : black in the bc1 3 colors mode, 2/3 of white otherwise
+        const uint8_t color_block[8] = {0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+        CompressedImage bc1{CompressedImage::Format::BC1, Eigen::Vector2i(4, 4), {}};
+        bc1.data.assign(color_block, color_block + 8);
+        REQUIRE(((uint8_t *)bc1.decode().get_data())[0] == 0);
+
+        CompressedImage bc3{CompressedImage::Format::BC3, Eigen::Vector2i(4, 4), {255, 255, 0, 0, 0, 0, 0, 0}};
+        bc3.data.insert(bc3.data.end(), color_block, color_block + 8);
+        REQUIRE(((uint8_t *)bc3.decode().get_data())[0] == 170);
+    }
+
+    SECTION("gray and alpha is expanded for bc3")
+    {
+        Image image = make_gradient(16, 8, 2);
+        Image decoded = CompressedImage::encode(image.view(), CompressedImage::Format::BC3).decode();
+        REQUIRE(decoded.get_channels() == 4);
+        double gray_error = 0.0, alpha_error = 0.0;
+        for (int i = 0; i < 16 * 8; i++)
+        {
+            const uint8_t *in = (const uint8_t *)image.get_data() + i * 2;
+            const uint8_t *out = (const uint8_t *)decoded.get_data() + i * 4;
+            for (int c = 0; c < 3; c++)
+            {
+                gray_error += std::abs(int(out[c]) - int(in[0]));
+            }
+            alpha_error += std::abs(int(out[3]) - int(in[1]));
+        }
+        REQUIRE(gray_error / (16 * 8 * 3) < 4.0);
+        REQUIRE(alpha_error / (16 * 8) < 4.0);
+    }
+
+    SECTION("serialization and cache")
+    {
+        Image image = make_gradient(16, 16, 3);
+        CompressedImage compressed = CompressedImage::encode(image.view(), CompressedImage::Format::BC1);
+        CompressedImage copy = CompressedImage::deserialize(compressed.serialize());
+        REQUIRE(copy.format == compressed.format);
+        REQUIRE(copy.dimensions == compressed.dimensions);
+        REQUIRE(copy.data == compressed.data);
+
+        std::string directory = "file://" + std::filesystem::temp_directory_path().string();
+        std::string uri = directory + "/" + image.get_hash() + ".bc1";
+        std::filesystem::remove(std::filesystem::temp_directory_path() / (image.get_hash() + ".bc1"));
+        CompressedImage::encode_cached(image, CompressedImage::Format::BC1, directory);
+        REQUIRE(FileSystem::get_entry(uri)->exists());
+        REQUIRE(CompressedImage::encode_cached(image, CompressedImage::Format::BC1, directory).data == compressed.data);
+    }
+}
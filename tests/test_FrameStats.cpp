@@ -0,0 +1,39 @@
+#include <catch2/catch_all.hpp>
+#include "FrameStats.hpp"
+
+using Catch::Matchers::WithinAbs;
+
+TEST_CASE("FrameStats", "[FrameStats]")
+{
+    SECTION("empty")
+    {
+        FrameStats stats = FrameStats::from_samples({});
+        REQUIRE(stats.frames == 0);
+        REQUIRE(stats.mean == 0.0);
+    }
+
+    SECTION("statistics of unsorted samples")
+    {
+        std::vector<double> samples;
+        for (int i = 100; i >= 1; i--)
+        {
+            samples.push_back(i);
+        }
+        FrameStats stats = FrameStats::from_samples(samples);
+        REQUIRE(stats.frames == 100);
+        REQUIRE_THAT(stats.mean, WithinAbs(50.5, 1e-9));
+        REQUIRE_THAT(stats.median, WithinAbs(50.5, 1e-9));
+        REQUIRE(stats.p95 == 95.0);
+        REQUIRE(stats.p99 == 99.0);
+        REQUIRE(stats.min == 1.0);
+        REQUIRE(stats.max == 100.0);
+    }
+
+    SECTION("single sample")
+    {
+        FrameStats stats = FrameStats::from_samples({16.0});
+        REQUIRE(stats.median == 16.0);
+        REQUIRE(stats.p99 == 16.0);
+        REQUIRE(stats.to_string() == "1 frames : mean 16.00ms, median 16.00ms, p95 16.00ms, p99 16.00ms, min 16.00ms, max 16.00ms");
+    }
+}
@@ -34,3 +34,58 @@ TEST_CASE("hit", "[Geometry]") {
     REQUIRE(ray.at(t).isApprox(Eigen::Vector3f(0.25, 0.25, 0))); // hit point is on the triangle
     REQUIRE(normal.isApprox(Eigen::Vector3f(0, 0, 1))); // normal is pointing up
 }
+
+TEST_CASE("adjacency", "[Geometry]") {
+
+    SECTION("closed mesh") {
+        auto cube = basegeometries::cube();
+        auto adjacency = cube.get_adjacency();
+        REQUIRE(adjacency == cube.get_adjacency()); // cached
+        REQUIRE(adjacency->get_face_count() == 12);
+        REQUIRE(adjacency->boundary_halfedges().empty());
+        REQUIRE(adjacency->get_non_manifold_edge_count() == 0);
+        for (uint32_t h = 0; h < adjacency->get_halfedge_count(); h++) {
+            uint32_t t = adjacency->twin(h);
+            REQUIRE(adjacency->twin(t) == h);
+            REQUIRE(adjacency->from(t) == adjacency->to(h));
+        }
+        for (uint32_t v = 0; v < 8; v++) {
+            REQUIRE_FALSE(adjacency->is_boundary_vertex(v));
+            REQUIRE(adjacency->neighbours(v).size() >= 3);
+        }
+    }
+
+    SECTION("open mesh") {
+        auto q = basegeometries::quad({0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0});
+        auto adjacency = q.get_adjacency();
+        REQUIRE(adjacency->boundary_halfedges().size() == 4);
+        auto neighbours = adjacency->face_neighbours(0);
+        REQUIRE(neighbours[2] == 1); // edge 2->0 is shared with the second triangle
+        REQUIRE(neighbours[0] == MeshAdjacency::INVALID);
+        REQUIRE(adjacency->is_boundary_vertex(0));
+        REQUIRE(adjacency->neighbours(0).size() == 3);
+        REQUIRE(adjacency->neighbours(1).size() == 2);
+    }
+
+    SECTION("rebuilt when topology changes") {
+        auto q = basegeometries::quad({0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0});
+        auto before = q.get_adjacency();
+        REQUIRE(before->get_face_count() == 2);
+        q.merge(basegeometries::triangle({1, 0, 0}, {2, 0, 0}, {1, 1, 0}));
+        REQUIRE(q.get_adjacency()->get_face_count() == 3);
+        REQUIRE(before->get_face_count() == 2); // still held by the caller
+    }
+
+    SECTION("invalid indices") {
+        REQUIRE_THROWS_AS(MeshAdjacency({0, 1}, 2), std::invalid_argument);
+        REQUIRE_THROWS_AS(MeshAdjacency({0, 1, 3}, 3), std::out_of_range);
+    }
+}
+
+TEST_CASE("hash", "[Geometry]") {
+    auto cube = basegeometries::cube();
+    REQUIRE(cube.get_hash() == basegeometries::cube().get_hash());
+    REQUIRE(cube.get_hash() == cube.copy().get_hash());
+    cube.translate({1, 0, 0});
+    REQUIRE(cube.get_hash() != basegeometries::cube().get_hash());
+}
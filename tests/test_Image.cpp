@@ -0,0 +1,118 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include "Image.hpp"
+#include "FileSystem.hpp"
+#include "TestImages.hpp"
+#include "stb_image.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+using Catch::Matchers::WithinAbs;
+
+TEST_CASE("Image", "[Image]")
+{
+    SECTION("copy and move")
+    {
+        Image image = make_gradient(8, 4, 3);
+        Image copy = image.copy();
+        REQUIRE(copy.get_data() != image.get_data());
+        REQUIRE(memcmp(copy.get_data(), image.get_data(), image.get_size()) == 0);
+
+        void *pixels = copy.get_data();
+        Image moved(std::move(copy));
+        REQUIRE(moved.get_data() == pixels);
+        REQUIRE(copy.get_data() == nullptr);
+    }
+
+    SECTION("views of a const image are read-only")
+    {
+        Image image = make_gradient(8, 4, 3);
+        const Image &read_only = image;
+        static_assert(std::is_same_v<decltype(read_only.view()), ConstImageView>);
+        static_assert(std::is_same_v<decltype(image.view(0, 0, 2, 2)), ImageView>);
+        REQUIRE(read_only.view(2, 1, 3, 2).get_pixel(0, 0) == image.view().get_pixel(2, 1));
+    }
+
+    SECTION("cropping")
+    {
+        Image image = make_gradient(8, 4, 3);
+        Image cropped = image.cropped(2, 1, 3, 2);
+        REQUIRE(cropped.get_dimensions() == Eigen::Vector2i(3, 2));
+        const uint8_t *pixels = (const uint8_t *)cropped.get_data();
+        REQUIRE(pixels[0] == gradient_value(2, 1, 0, 8));
+        REQUIRE(pixels[9] == gradient_value(2, 2, 0, 8));
+        REQUIRE(pixels[10] == gradient_value(2, 2, 1, 8));
+    }
+
+    SECTION("mip chain")
+    {
+        Image image(37, 20, 4);
+        memset(image.get_data(), 200, image.get_size());
+        auto levels = image.build_mip_chain(true);
+        std::vector<Eigen::Vector2i> expected = {{18, 10}, {9, 5}, {4, 2}, {2, 1}, {1, 1}};
+        REQUIRE(levels.size() == expected.size());
+        for (size_t i = 0; i < levels.size(); i++)
+        {
+            REQUIRE(levels[i].get_dimensions() == expected[i]);
+            REQUIRE(((uint8_t *)levels[i].get_data())[0] == 200);
+        }
+    }
+
+    SECTION("lossless encodings round trip")
+    {
+        Image image = make_gradient(8, 4, 3);
+        for (auto format : {"png", "bmp", "tga"})
+        {
+            Image decoded = Image::load(image.encode(format, Image::Compression::Fast));
+            REQUIRE(decoded.get_dimensions() == image.get_dimensions());
+            REQUIRE(decoded.get_channels() == image.get_channels());
+            REQUIRE(memcmp(decoded.get_data(), image.get_data(), image.get_size()) == 0);
+        }
+    }
+
+    SECTION("hdr stores linear radiance")
+    {
+        Image gray(1, 1, 3);
+        memset(gray.get_data(), 128, gray.get_size());
+        Blob encoded = gray.encode("hdr");
+        int width, height, channels;
+        float *radiance = stbi_loadf_from_memory((const stbi_uc *)encoded.get_ptr(), int(encoded.get_size()), &width, &height, &channels, 3);
+        REQUIRE(radiance != nullptr);
+        for (int i = 0; i < 3; i++)
+        {
+            REQUIRE_THAT(radiance[i], WithinAbs(0.2158, 0.005)); // srgb 128 in linear
+        }
+        stbi_image_free(radiance);
+
+        // the loader maps radiance back to gamma encoded bytes
+        Image decoded = Image::load(encoded);
+        REQUIRE(std::abs(((uint8_t *)decoded.get_data())[0] - 128) <= 2);
+    }
+
+    SECTION("save and save_async")
+    {
+        FileSystem::get_entry("tmp://zengine_tests")->create_directories();
+        Image image = make_gradient(8, 4, 3);
+        image.save("tmp://zengine_tests/gradient.png");
+        Image loaded = Image::load("tmp://zengine_tests/gradient.png");
+        REQUIRE(loaded.get_dimensions() == image.get_dimensions());
+        REQUIRE(memcmp(loaded.get_data(), image.get_data(), image.get_size()) == 0);
+
+        // the copy is saved, the image can change right after the call
+        auto saved = image.save_async("tmp://zengine_tests/gradient_async.bmp");
+        memset(image.get_data(), 0, image.get_size());
+        saved.get();
+        loaded = Image::load("tmp://zengine_tests/gradient_async.bmp");
+        REQUIRE(memcmp(loaded.get_data(), make_gradient(8, 4, 3).get_data(), image.get_size()) == 0);
+
+        REQUIRE_THROWS_AS(image.save_async("tmp://zengine_tests/gradient.xyz").get(), std::runtime_error);
+    }
+
+    SECTION("unknown format")
+    {
+        REQUIRE_THROWS_AS(make_gradient(8, 4, 3).encode("xyz"), std::runtime_error);
+    }
+}
@@ -0,0 +1,139 @@
+#include <catch2/catch_test_macros.hpp>
+#include "ImageKernels.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static std::vector<uint8_t> make_pixels(int width, int height, int channels)
+{
+    std::vector<uint8_t> pixels(size_t(width) * height * channels);
+    for (size_t i = 0; i < pixels.size(); i++)
+    {
+        pixels[i] = uint8_t(i * 31 + i / 251);
+    }
+    return pixels;
+}
+
+// dst(x, y) = src(sx(x, y), sy(x, y)), computed pixel by pixel
+template <typename F>
+static std::vector<uint8_t> reference(const std::vector<uint8_t> &src, int width, int channels, int dst_width, int dst_height, F source)
+{
+    std::vector<uint8_t> dst(size_t(dst_width) * dst_height * channels);
+    for (int y = 0; y < dst_height; y++)
+    {
+        for (int x = 0; x < dst_width; x++)
+        {
+            auto [sx, sy] = source(x, y);
+            memcpy(&dst[(size_t(y) * dst_width + x) * channels], &src[(size_t(sy) * width + sx) * channels], channels);
+        }
+    }
+    return dst;
+}
+
+TEST_CASE("ImageKernels", "[ImageKernels]")
+{
+    // sizes covering full tiles, partial tiles and non square shapes
+    const int sizes[][2] = {{1, 1}, {16, 16}, {37, 21}, {64, 48}, {5, 70}};
+
+    for (int channels = 1; channels <= 4; channels++)
+    {
+        for (auto &size : sizes)
+        {
+            int w = size[0], h = size[1];
+            auto src = make_pixels(w, h, channels);
+            ImageView src_view(src.data(), w, h, channels);
+            std::vector<uint8_t> dst(src.size());
+            ImageView dst_view(dst.data(), h, w, channels);
+
+            auto transposed = reference(src, w, channels, h, w, [](int x, int y)
+                                        { return std::pair(y, x); });
+
+            imagekernels::transpose(src_view, dst_view);
+            REQUIRE(dst == transposed);
+
+            auto in_place = src;
+            imagekernels::transpose_in_place(in_place.data(), w, h, channels);
+            REQUIRE(in_place == transposed);
+
+            imagekernels::rotate_clockwise(src_view, dst_view);
+            REQUIRE(dst == reference(src, w, channels, h, w, [h](int x, int y)
+                                     { return std::pair(y, h - 1 - x); }));
+
+            imagekernels::rotate_counterclockwise(src_view, dst_view);
+            REQUIRE(dst == reference(src, w, channels, h, w, [w](int x, int y)
+                                     { return std::pair(w - 1 - y, x); }));
+
+            auto flipped = src;
+            imagekernels::flip_horizontally(ImageView(flipped.data(), w, h, channels));
+            REQUIRE(flipped == reference(src, w, channels, w, h, [w](int x, int y)
+                                         { return std::pair(w - 1 - x, y); }));
+
+            flipped = src;
+            imagekernels::flip_vertically(ImageView(flipped.data(), w, h, channels));
+            REQUIRE(flipped == reference(src, w, channels, w, h, [h](int x, int y)
+                                         { return std::pair(x, h - 1 - y); }));
+        }
+    }
+
+    SECTION("strided views")
+    {
+        auto src = make_pixels(40, 40, 4);
+        ImageView window = ImageView(src.data(), 40, 40, 4).sub(3, 5, 32, 17);
+        std::vector<uint8_t> dst(32 * 17 * 4);
+        imagekernels::transpose(window, ImageView(dst.data(), 17, 32, 4));
+        for (int y = 0; y < 17; y++)
+        {
+            for (int x = 0; x < 32; x++)
+            {
+                REQUIRE(memcmp(&dst[(size_t(x) * 17 + y) * 4], window.get_pixel(x, y), 4) == 0);
+            }
+        }
+    }
+}
+
+TEST_CASE("ImageKernels resample", "[ImageKernels]")
+{
+    SECTION("same size is the identity")
+    {
+        auto src = make_pixels(23, 17, 3);
+        std::vector<uint8_t> dst(src.size());
+        imagekernels::resample(ImageView(src.data(), 23, 17, 3), ImageView(dst.data(), 23, 17, 3));
+        REQUIRE(dst == src);
+        imagekernels::resample(ImageView(src.data(), 23, 17, 3), ImageView(dst.data(), 23, 17, 3), true);
+        for (size_t i = 0; i < src.size(); i++)
+        {
+            REQUIRE(std::abs(int(dst[i]) - int(src[i])) <= 1);
+        }
+    }
+
+    SECTION("uniform colors are preserved")
+    {
+        std::vector<uint8_t> src(100 * 60 * 4);
+        for (size_t i = 0; i < src.size(); i++)
+        {
+            src[i] = uint8_t(10 + 40 * (i % 4));
+        }
+        for (auto [w, h] : {std::pair(33, 21), std::pair(250, 7), std::pair(1, 1)})
+        {
+            std::vector<uint8_t> dst(size_t(w) * h * 4);
+            imagekernels::resample(ImageView(src.data(), 100, 60, 4), ImageView(dst.data(), w, h, 4), true);
+            for (size_t i = 0; i < dst.size(); i++)
+            {
+                REQUIRE(std::abs(int(dst[i]) - int(src[i % 4])) <= 1);
+            }
+        }
+    }
+
+    SECTION("srgb averages in linear space")
+    {
+        // black and white columns, downscaled to a single pixel
+        uint8_t src[4] = {0, 255, 0, 255};
+        uint8_t dst = 0;
+        imagekernels::resample(ImageView(src, 4, 1, 1), ImageView(&dst, 1, 1, 1), false);
+        REQUIRE(std::abs(int(dst) - 128) <= 1);
+        imagekernels::resample(ImageView(src, 4, 1, 1), ImageView(&dst, 1, 1, 1), true);
+        REQUIRE(std::abs(int(dst) - 188) <= 1);
+    }
+}
+
@@ -0,0 +1,70 @@
+#include <catch2/catch_test_macros.hpp>
+#include "ImageLoader.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <vector>
+
+static std::string temp_uri(const std::string &name)
+{
+    return "file://" + (std::filesystem::temp_directory_path() / name).string();
+}
+
+TEST_CASE("ImageLoader", "[ImageLoader]")
+{
+    Image image(6, 4, 3);
+    memset(image.get_data(), 77, image.get_size());
+    image.save(temp_uri("zengine_loader.png"));
+
+    SECTION("load")
+    {
+        ImageLoader loader(2);
+        auto ticket = loader.load(temp_uri("zengine_loader.png"));
+        Image loaded = ticket.get();
+        REQUIRE(loaded.get_dimensions() == Eigen::Vector2i(6, 4));
+        REQUIRE(((uint8_t *)loaded.get_data())[5] == 77);
+    }
+
+    SECTION("errors are forwarded")
+    {
+        ImageLoader loader(1);
+        auto ticket = loader.load(temp_uri("zengine_missing.png"));
+        REQUIRE_THROWS(ticket.get());
+    }
+
+    SECTION("priorities and abandoned requests")
+    {
+        ImageLoader loader(1);
+        std::mutex mutex;
+        std::vector<int> order;
+        auto record = [&](int id)
+        {
+            return [&, id](const Image &)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                order.push_back(id);
+            };
+        };
+
+        // keeps the only worker busy while the other requests are queued
+        std::promise<void> started, release;
+        std::shared_future<void> released = release.get_future().share();
+        auto blocker = loader.load(temp_uri("zengine_loader.png"), 0, [&started, released](const Image &)
+                                   { started.set_value(); released.wait(); });
+        started.get_future().wait();
+
+        auto low = loader.load(temp_uri("zengine_loader.png"), 1, record(1));
+        auto high = loader.load(temp_uri("zengine_loader.png"), 5, record(5));
+        loader.load(temp_uri("zengine_loader.png"), 9, record(9)); // ticket dropped right away
+        auto cancelled = loader.load(temp_uri("zengine_loader.png"), 3, record(3));
+        cancelled.cancel();
+
+        release.set_value();
+        blocker.get();
+        low.get();
+        high.get();
+        REQUIRE_THROWS(cancelled.get());
+        REQUIRE(order == std::vector<int>{5, 1});
+    }
+}
@@ -0,0 +1,51 @@
+#include <catch2/catch_test_macros.hpp>
+#include "ImageView.hpp"
+
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+TEST_CASE("ImageView", "[ImageView]")
+{
+    // 4x3 rgb image, each byte holds its own offset
+    std::vector<uint8_t> pixels(4 * 3 * 3);
+    for (size_t i = 0; i < pixels.size(); i++)
+    {
+        pixels[i] = uint8_t(i);
+    }
+    ImageView view(pixels.data(), 4, 3, 3);
+
+    SECTION("contiguous")
+    {
+        REQUIRE(view.get_stride() == 12);
+        REQUIRE(view.is_contiguous());
+        REQUIRE(view.get_pixel(2, 1)[0] == 18);
+    }
+
+    SECTION("sub views share the pixels")
+    {
+        ImageView sub = view.sub(1, 1, 2, 2);
+        REQUIRE(sub.get_data() == pixels.data() + 15);
+        REQUIRE(sub.get_stride() == 12);
+        REQUIRE_FALSE(sub.is_contiguous());
+
+        std::vector<uint8_t> packed(sub.get_size());
+        sub.copy_to(packed.data());
+        REQUIRE(packed == std::vector<uint8_t>{15, 16, 17, 18, 19, 20, 27, 28, 29, 30, 31, 32});
+    }
+
+    SECTION("read-only views")
+    {
+        ConstImageView read_only = view.sub(1, 1, 2, 2);
+        static_assert(std::is_same_v<decltype(read_only.get_pixel(0, 0)), const uint8_t *>);
+        static_assert(!std::is_convertible_v<ConstImageView, ImageView>);
+        REQUIRE(read_only.get_data() == pixels.data() + 15);
+        REQUIRE(read_only.get_pixel(1, 1)[0] == 30);
+    }
+
+    SECTION("bounds are checked")
+    {
+        REQUIRE_THROWS_AS(view.sub(3, 0, 2, 1), std::out_of_range);
+        REQUIRE_THROWS_AS(ImageView(pixels.data(), 4, 3, 3, 8), std::invalid_argument);
+    }
+}
@@ -0,0 +1,27 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "MeshRegistry.hpp"
+
+TEST_CASE("deduplication", "[MeshRegistry]") {
+    MeshRegistry registry;
+
+    auto a = registry.add(basegeometries::cube());
+    auto b = registry.add(basegeometries::cube());
+    REQUIRE(a == b);
+    REQUIRE(registry.get_size() == 1);
+
+    int calls = 0;
+    auto factory = [&calls]() { calls++; return basegeometries::cube(); };
+    auto c = registry.get_or_create("cube", factory);
+    auto d = registry.get_or_create("cube", factory);
+    REQUIRE(calls == 1);
+    REQUIRE(c == a);
+    REQUIRE(d == a);
+
+    // released when unused
+    a.reset(); b.reset(); c.reset(); d.reset();
+    registry.purge();
+    REQUIRE(registry.get_size() == 0);
+    registry.get_or_create("cube", factory);
+    REQUIRE(calls == 2);
+}
@@ -0,0 +1,99 @@
+#include <catch2/catch_all.hpp>
+using namespace Catch::Matchers;
+
+#include "MeshStream.hpp"
+#include "FileSystem.hpp"
+#include "Sdf.hpp"
+
+#include <filesystem>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+static std::string temp_uri(const std::string &name)
+{
+    return "file://" + (std::filesystem::temp_directory_path() / name).string();
+}
+
+TEST_CASE("write and read back", "[MeshStream]") {
+    Geometry cube = basegeometries::cube();
+    cube.recompute_normals();
+    MeshStream::write(temp_uri("zengine_cube.zmsh"), cube, {5});
+
+    MeshStream stream(temp_uri("zengine_cube.zmsh"));
+    auto stats = stream.get_stats();
+    REQUIRE(stats.batches == 3); // 12 triangles, 5 per batch
+    REQUIRE(stats.triangles == 12);
+    REQUIRE(stats.bounds.min().isApprox(Eigen::Vector3f(-0.5, -0.5, -0.5)));
+    REQUIRE(stats.bounds.max().isApprox(Eigen::Vector3f(0.5, 0.5, 0.5)));
+    stream.for_each_batch([](const Geometry &batch) {
+        REQUIRE(batch.normals.size() == batch.vertices.size());
+        return true;
+    });
+}
+
+TEST_CASE("convert obj", "[MeshStream]") {
+    Geometry sphere = sdf::mesh(sdf::sphere(1.0f), {-1.5, -1.5, -1.5}, {1.5, 1.5, 1.5}, 64);
+    std::ostringstream obj;
+    sphere.to_obj(obj, "sphere");
+    obj << "v 0 5 0\nv 0 5 1\nv 1 5 1\nv 1 5 0\nf -4 -3 -2 -1\n"; // a quad with relative indices
+    FileSystem::get_entry(temp_uri("zengine_sphere.obj"))->write(obj.str().data(), obj.str().size());
+
+    // a cache of two pages and small batches, so that everything goes through the disk
+    MeshStreamOptions options;
+    options.batch_triangles = 1000;
+    options.cache_bytes = 1;
+    MeshStream::convert_obj(temp_uri("zengine_sphere.obj"), temp_uri("zengine_sphere.zmsh"), options);
+
+    MeshStream stream(temp_uri("zengine_sphere.zmsh"));
+    auto stats = stream.get_stats();
+    REQUIRE(stats.triangles == sphere.indices.size() / 3 + 2);
+    REQUIRE(stats.batches == (stats.triangles + 999) / 1000);
+
+    size_t on_sphere = 0;
+    stream.for_each_batch([&](const Geometry &batch) {
+        for (size_t i = 0; i < batch.vertices.size(); i++) {
+            if (std::abs(batch.vertices[i].norm() - 1.0f) < 0.05f) {
+                REQUIRE(batch.normals[i].dot(batch.vertices[i].normalized()) > 0.95f);
+                on_sphere++;
+            }
+        }
+        return true;
+    });
+    REQUIRE(on_sphere > 0);
+}
+
+TEST_CASE("empty batches are rejected", "[MeshStream]") {
+    MeshStreamOptions options;
+    options.batch_triangles = 0;
+    REQUIRE_THROWS_AS(MeshStream::write(temp_uri("zengine_empty_batches.zmsh"), basegeometries::cube(), options), std::invalid_argument);
+    REQUIRE_THROWS_AS(MeshStream::convert_obj(temp_uri("zengine_sphere.obj"), temp_uri("zengine_empty_batches.zmsh"), options), std::invalid_argument);
+}
+
+TEST_CASE("corrupted streams", "[MeshStream]") {
+    MeshStream::write(temp_uri("zengine_corrupted.zmsh"), basegeometries::cube(), {5});
+    Blob blob = FileSystem::get_entry(temp_uri("zengine_corrupted.zmsh"))->read();
+    std::string data(reinterpret_cast<const char *>(blob.get_ptr()), blob.get_size());
+
+    SECTION("counts larger than the file") {
+        std::string corrupted = data;
+        memset(corrupted.data() + 12, 0xFF, 4); // vertex count of the first batch
+        FileSystem::get_entry(temp_uri("zengine_corrupted.zmsh"))->write(corrupted.data(), corrupted.size());
+        MeshStream stream(temp_uri("zengine_corrupted.zmsh"));
+        REQUIRE_THROWS_AS(stream.get_stats(), std::runtime_error);
+    }
+
+    SECTION("indices out of range") {
+        std::string corrupted = data;
+        memset(corrupted.data() + corrupted.size() - 4, 0xFF, 4); // last index of the last batch
+        FileSystem::get_entry(temp_uri("zengine_corrupted.zmsh"))->write(corrupted.data(), corrupted.size());
+        MeshStream stream(temp_uri("zengine_corrupted.zmsh"));
+        REQUIRE_THROWS_AS(stream.get_stats(), std::runtime_error);
+    }
+
+    SECTION("truncated file") {
+        FileSystem::get_entry(temp_uri("zengine_corrupted.zmsh"))->write(data.data(), data.size() - 10);
+        MeshStream stream(temp_uri("zengine_corrupted.zmsh"));
+        REQUIRE_THROWS_AS(stream.get_stats(), std::runtime_error);
+    }
+}
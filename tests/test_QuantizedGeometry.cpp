@@ -0,0 +1,59 @@
+#include <catch2/catch_all.hpp>
+using namespace Catch::Matchers;
+
+#include "QuantizedGeometry.hpp"
+#include "VertexBuffer.hpp"
+#include "Math.hpp"
+
+TEST_CASE("octahedral", "[QuantizedGeometry]") {
+    for (auto n : {Eigen::Vector3f(0, 0, 1), Eigen::Vector3f(0, 0, -1), Eigen::Vector3f(1, -2, -3).normalized(), Eigen::Vector3f(-1, 1, 0.5).normalized()}) {
+        Eigen::Vector2f e = octahedral_encode(n);
+        REQUIRE(e.cwiseAbs().maxCoeff() <= 1.0f);
+        REQUIRE(octahedral_decode(e).isApprox(n, 1e-5));
+    }
+}
+
+TEST_CASE("quantize", "[QuantizedGeometry]") {
+    Geometry geometry = basegeometries::cube();
+    geometry.scale({4, 2, 1});
+    geometry.recompute_normals();
+
+    SECTION("8 bits normals") {
+        auto quantized = QuantizedGeometry::quantize(geometry);
+        REQUIRE(quantized.stride == 8);
+        REQUIRE(quantized.data.size() == 8 * 8);
+        Geometry back = quantized.dequantize();
+        for (size_t i = 0; i < geometry.vertices.size(); i++) {
+            REQUIRE(back.vertices[i].isApprox(geometry.vertices[i], 1e-4));
+            REQUIRE(back.normals[i].dot(geometry.normals[i]) > 0.999f);
+        }
+        Eigen::Vector4f p = quantized.get_dequantization_matrix() * Eigen::Vector4f(1, 1, 1, 1);
+        REQUIRE(p.head<3>().isApprox(Eigen::Vector3f(2, 1, 0.5)));
+    }
+
+    SECTION("16 bits normals") {
+        auto quantized = QuantizedGeometry::quantize(geometry, QuantizedGeometry::NormalBits::Bits16);
+        REQUIRE(quantized.stride == 12);
+        Geometry back = quantized.dequantize();
+        for (size_t i = 0; i < geometry.vertices.size(); i++) {
+            REQUIRE(back.normals[i].dot(geometry.normals[i]) > 0.99999f);
+        }
+    }
+}
+
+TEST_CASE("normalized formats", "[QuantizedGeometry]") {
+    auto quantized = QuantizedGeometry::quantize(basegeometries::cube());
+    auto position = VertexStructure::parse_format(quantized.get_position_format());
+    REQUIRE(position.offset == 0);
+    REQUIRE(position.components_count == 3);
+    REQUIRE(position.stride == 8);
+    REQUIRE(position.normalized);
+    auto normal = VertexStructure::parse_format(quantized.get_normal_format());
+    REQUIRE(normal.offset == 6);
+    REQUIRE(normal.components_count == 2);
+    REQUIRE(normal.size == 2);
+    REQUIRE(normal.stride == 8);
+    REQUIRE(normal.normalized);
+    REQUIRE_FALSE(VertexStructure::parse_format("f[3]").normalized);
+    REQUIRE(VertexStructure::parse_format("f[3]").components_count == 3);
+}
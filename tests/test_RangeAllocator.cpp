@@ -0,0 +1,55 @@
+#include <catch2/catch_test_macros.hpp>
+#include "RangeAllocator.hpp"
+
+#include <stdexcept>
+
+TEST_CASE("RangeAllocator", "[RangeAllocator]")
+{
+    RangeAllocator allocator(100);
+    REQUIRE(allocator.get_capacity() == 100);
+    REQUIRE(allocator.get_free_size() == 100);
+
+    SECTION("first fit")
+    {
+        REQUIRE(allocator.allocate(30) == 0);
+        REQUIRE(allocator.allocate(30) == 30);
+        REQUIRE(allocator.allocate(50) == RangeAllocator::INVALID);
+        REQUIRE(allocator.allocate(40) == 60);
+        REQUIRE(allocator.get_free_size() == 0);
+    }
+
+    SECTION("released ranges are merged")
+    {
+        size_t a = allocator.allocate(20);
+        size_t b = allocator.allocate(20);
+        size_t c = allocator.allocate(20);
+        allocator.release(a, 20);
+        allocator.release(c, 20);
+        REQUIRE(allocator.allocate(70) == RangeAllocator::INVALID); // 20 + 60 free, but not contiguous
+        allocator.release(b, 20);
+        REQUIRE(allocator.allocate(100) == 0);
+    }
+
+    SECTION("a hole is reused")
+    {
+        allocator.allocate(10);
+        size_t hole = allocator.allocate(10);
+        allocator.allocate(10);
+        allocator.release(hole, 10);
+        REQUIRE(allocator.allocate(5) == hole);
+        REQUIRE(allocator.allocate(5) == hole + 5);
+    }
+
+    SECTION("growing extends the last free range")
+    {
+        allocator.allocate(90);
+        allocator.grow(200);
+        REQUIRE(allocator.get_free_size() == 110);
+        REQUIRE(allocator.allocate(110) == 90);
+    }
+
+    SECTION("errors")
+    {
+        REQUIRE_THROWS_AS(allocator.release(90, 20), std::out_of_range);
+    }
+}
@@ -0,0 +1,43 @@
+#include <catch2/catch_all.hpp>
+using namespace Catch::Matchers;
+
+#include "Sdf.hpp"
+
+static float signed_volume(const Geometry &geometry)
+{
+    float volume = 0;
+    geometry.for_each_triangle([&](const Eigen::Vector3f &a, const Eigen::Vector3f &b, const Eigen::Vector3f &c) {
+        volume += a.dot(b.cross(c)) / 6.0f;
+        return true;
+    });
+    return volume;
+}
+
+TEST_CASE("sphere", "[Sdf]") {
+    // 80 cells per side, so the sphere spans several blocks
+    Geometry sphere = sdf::mesh(sdf::sphere(1.0f), {-1.5, -1.5, -1.5}, {1.5, 1.5, 1.5}, 80);
+
+    REQUIRE(sphere.vertices.size() > 0);
+    REQUIRE(sphere.normals.size() == sphere.vertices.size());
+    for (size_t i = 0; i < sphere.vertices.size(); i++) {
+        REQUIRE_THAT(sphere.vertices[i].norm(), WithinAbs(1.0, 0.02));
+        REQUIRE(sphere.normals[i].dot(sphere.vertices[i].normalized()) > 0.99f);
+    }
+
+    // welded and closed, with outward facing triangles
+    auto adjacency = sphere.get_adjacency();
+    REQUIRE(adjacency->boundary_halfedges().empty());
+    REQUIRE(adjacency->get_non_manifold_edge_count() == 0);
+    REQUIRE_THAT(signed_volume(sphere), WithinRel(4.0 / 3.0 * M_PI, 0.02));
+}
+
+TEST_CASE("combinators", "[Sdf]") {
+    auto a = sdf::sphere(1.0f);
+    auto b = sdf::translated(sdf::sphere(1.0f), {1.5f, 0.0f, 0.0f});
+    Eigen::Vector3f between(0.75f, 0.7f, 0.0f);
+    REQUIRE(sdf::unite(a, b)(between) > 0.0f);
+    REQUIRE(sdf::smooth_union(a, b, 0.5f)(between) < sdf::unite(a, b)(between));
+    REQUIRE(sdf::subtract(a, b)({1.0f, 0.0f, 0.0f}) > 0.0f);
+    REQUIRE(sdf::intersect(a, b)({0.75f, 0.0f, 0.0f}) < 0.0f);
+    REQUIRE_THAT(sdf::box({1, 1, 1})({2, 0, 0}), WithinAbs(1.0, 1e-6));
+}
@@ -0,0 +1,28 @@
+#include <catch2/catch_test_macros.hpp>
+#include "ShaderProgram.hpp"
+
+TEST_CASE("UniformName", "[ShaderProgram]")
+{
+    SECTION("literals are hashed at compile time")
+    {
+        constexpr UniformName name = "mvp"_uniform;
+        static_assert(name.hash == UniformName::get_hash("mvp"));
+        static_assert(name.name == "mvp");
+    }
+
+    SECTION("same hash whatever the string type")
+    {
+        std::string str("view_projection");
+        REQUIRE(UniformName(str).hash == "view_projection"_uniform.hash);
+        REQUIRE(UniformName("view_projection").hash == "view_projection"_uniform.hash);
+        REQUIRE(UniformName(str).hash != "view"_uniform.hash);
+    }
+
+    SECTION("default handles are invalid")
+    {
+        Uniform<float> handle;
+        REQUIRE_FALSE(handle.is_valid());
+        REQUIRE(handle.get_location() == -1);
+        handle.set(1.0f); // ignored, without any gl call
+    }
+}
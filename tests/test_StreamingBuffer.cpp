@@ -0,0 +1,53 @@
+#include <catch2/catch_test_macros.hpp>
+#include "StreamingBuffer.hpp"
+
+#include <stdexcept>
+
+TEST_CASE("StreamingRing", "[StreamingBuffer]")
+{
+    SECTION("offsets are aligned in the buffer, whatever the segment size")
+    {
+        StreamingRing ring(1000, 3);
+        for (int frame = 0; frame < 4; frame++)
+        {
+            size_t start = ring.allocate(24, 256);
+            REQUIRE(start % 256 == 0);
+            REQUIRE(start >= ring.get_current() * size_t(1000));
+            REQUIRE(start + 24 <= (ring.get_current() + 1) * size_t(1000));
+            REQUIRE(ring.allocate(8, 16) % 16 == 0);
+            REQUIRE(ring.next_segment());
+        }
+        REQUIRE(ring.get_current() == 1);
+    }
+
+    SECTION("a full segment throws")
+    {
+        StreamingRing ring(100, 2);
+        ring.allocate(60, 16);
+        REQUIRE_THROWS_AS(ring.allocate(60, 16), std::runtime_error);
+        REQUIRE(ring.next_segment());
+        // the second segment starts at 100, aligned on 64 the allocation starts at 128 and 28 + 80 bytes do not fit
+        REQUIRE_THROWS_AS(ring.allocate(80, 64), std::runtime_error);
+        REQUIRE(ring.allocate(72, 64) == 128);
+    }
+
+    SECTION("a zero alignment throws")
+    {
+        StreamingRing ring(100, 2);
+        REQUIRE_THROWS_AS(ring.allocate(8, 0), std::invalid_argument);
+    }
+
+    SECTION("an unused segment is kept")
+    {
+        StreamingRing ring(64, 3);
+        REQUIRE_FALSE(ring.next_segment());
+        REQUIRE(ring.get_current() == 0);
+        REQUIRE(ring.get_used_size() == 0);
+    }
+
+    SECTION("at least one segment")
+    {
+        REQUIRE_THROWS_AS(StreamingRing(64, 0), std::invalid_argument);
+        REQUIRE_THROWS_AS(StreamingRing(64, -1), std::invalid_argument);
+    }
+}
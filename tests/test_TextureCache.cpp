@@ -0,0 +1,113 @@
+#include <catch2/catch_test_macros.hpp>
+#include "TextureCache.hpp"
+#include "FileSystem.hpp"
+
+#include <filesystem>
+#include <string>
+
+static std::string temp_uri(const std::string &name, const std::string &content)
+{
+    std::string uri = "file://" + (std::filesystem::temp_directory_path() / name).string();
+    FileSystem::get_entry(uri)->write(content.data(), content.size());
+    return uri;
+}
+
+TEST_CASE("TextureCache", "[TextureCache]")
+{
+    // no gl here : the factory only records the uploads, each one weighs 100 bytes
+    int uploads = 0;
+    TextureCache cache(250, [&uploads](const Blob &)
+                       {
+                           uploads++;
+                           return TextureCache::Upload{nullptr, 100};
+                       });
+    std::string a = temp_uri("zengine_cache_a.bin", "a");
+    std::string b = temp_uri("zengine_cache_b.bin", "b");
+    std::string c = temp_uri("zengine_cache_c.bin", "c");
+    std::string a_copy = temp_uri("zengine_cache_a_copy.bin", "a");
+
+    SECTION("files are read on first use")
+    {
+        auto handle = cache.get(a);
+        REQUIRE(uploads == 0);
+        REQUIRE_FALSE(handle.is_resident());
+        handle.get();
+        handle.get();
+        REQUIRE(uploads == 1);
+        REQUIRE(handle.is_resident());
+        REQUIRE(cache.get_usage() == 100);
+        REQUIRE(cache.get(a).get_uri() == a);
+    }
+
+    SECTION("the same content is uploaded once")
+    {
+        cache.get(a).get();
+        cache.get(a_copy).get();
+        REQUIRE(uploads == 1);
+        REQUIRE(cache.get_resident_count() == 1);
+        REQUIRE(cache.get(a_copy).is_resident());
+    }
+
+    SECTION("the least recently used texture is evicted over budget")
+    {
+        auto ha = cache.get(a);
+        auto hb = cache.get(b);
+        auto hc = cache.get(c);
+        ha.get();
+        hb.get();
+        ha.get(); // b is now the least recently used
+        hc.get();
+        REQUIRE(cache.get_usage() == 200);
+        REQUIRE(ha.is_resident());
+        REQUIRE_FALSE(hb.is_resident());
+        REQUIRE(hc.is_resident());
+
+        // an evicted handle stays valid, its texture is uploaded again
+        hb.get();
+        REQUIRE(uploads == 4);
+        REQUIRE(hb.is_resident());
+        REQUIRE_FALSE(ha.is_resident());
+    }
+
+    SECTION("an evicted texture still held by a caller is not uploaded again")
+    {
+        // the textures alias a token, they are never dereferenced but expire like real ones
+        TextureCache held_cache(100, [&uploads](const Blob &)
+                                {
+                                    uploads++;
+                                    return TextureCache::Upload{std::shared_ptr<Texture>(std::make_shared<int>(), nullptr), 100};
+                                });
+        auto ha = held_cache.get(a);
+        auto hb = held_cache.get(b);
+        auto kept = ha.get();
+        hb.get();
+        REQUIRE_FALSE(ha.is_resident());
+
+        ha.get();
+        REQUIRE(uploads == 2);
+        REQUIRE(held_cache.get_usage() == 100);
+
+        hb.get();
+        kept.reset();
+        ha.get();
+        REQUIRE(uploads == 4);
+    }
+
+    SECTION("budget changes and clear")
+    {
+        cache.get(a).get();
+        cache.get(b).get();
+        cache.set_budget(100);
+        REQUIRE(cache.get_resident_count() == 1);
+        REQUIRE(cache.get(b).is_resident());
+
+        // a single texture is kept even when it exceeds the budget by itself
+        cache.set_budget(10);
+        REQUIRE(cache.get_resident_count() == 1);
+
+        cache.clear();
+        REQUIRE(cache.get_resident_count() == 0);
+        REQUIRE(cache.get_usage() == 0);
+        REQUIRE_FALSE(cache.get(b).is_resident());
+    }
+}
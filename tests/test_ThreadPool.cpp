@@ -0,0 +1,39 @@
+#include <catch2/catch_test_macros.hpp>
+#include "ThreadPool.hpp"
+
+#include <atomic>
+#include <stdexcept>
+
+TEST_CASE("ThreadPool", "[ThreadPool]")
+{
+    SECTION("submit returns the result")
+    {
+        ThreadPool pool(2);
+        REQUIRE(pool.get_thread_count() == 2);
+        auto future = pool.submit([]()
+                                  { return 42; });
+        REQUIRE(future.get() == 42);
+    }
+
+    SECTION("exceptions are forwarded to the future")
+    {
+        ThreadPool pool(1);
+        auto future = pool.submit([]()
+                                  { throw std::runtime_error("failed"); });
+        REQUIRE_THROWS_AS(future.get(), std::runtime_error);
+    }
+
+    SECTION("queued tasks complete before destruction")
+    {
+        std::atomic<int> count = 0;
+        {
+            ThreadPool pool(3);
+            for (int i = 0; i < 100; i++)
+            {
+                pool.submit([&count]()
+                            { count++; });
+            }
+        }
+        REQUIRE(count == 100);
+    }
+}
@@ -0,0 +1,49 @@
+#include <catch2/catch_test_macros.hpp>
+#include "UniformBuffer.hpp"
+
+#include <stdexcept>
+
+using Type = Std140Layout::Type;
+
+TEST_CASE("Std140Layout", "[UniformBuffer]")
+{
+    SECTION("scalars and vectors")
+    {
+        // vec3 is aligned on 16 bytes, but a float can follow it in the same slot
+        auto layout = Std140Layout::parse_format("f v3 f v2 v4");
+        REQUIRE(layout.members.size() == 5);
+        REQUIRE(layout.members[0].offset == 0);
+        REQUIRE(layout.members[1].offset == 16);
+        REQUIRE(layout.members[2].offset == 28);
+        REQUIRE(layout.members[3].offset == 32);
+        REQUIRE(layout.members[4].offset == 48);
+        REQUIRE(layout.members[4].type == Type::Vec4);
+        REQUIRE(layout.size == 64);
+    }
+
+    SECTION("matrices and arrays are padded to vec4")
+    {
+        auto layout = Std140Layout::parse_format("f m3 f[3] m4[2] i");
+        REQUIRE(layout.members[1].offset == 16);
+        REQUIRE(layout.members[1].stride == 48);
+        REQUIRE(layout.members[2].offset == 64);
+        REQUIRE(layout.members[2].stride == 16);
+        REQUIRE(layout.members[2].count == 3);
+        REQUIRE(layout.members[3].offset == 112);
+        REQUIRE(layout.members[3].stride == 64);
+        REQUIRE(layout.members[4].offset == 240);
+        REQUIRE(layout.size == 256);
+    }
+
+    SECTION("camera block")
+    {
+        auto layout = Std140Layout::parse_format("m4 m4 m4 v3");
+        REQUIRE(layout.members[3].offset == 192);
+        REQUIRE(layout.size == 208);
+    }
+
+    SECTION("unknown type")
+    {
+        REQUIRE_THROWS_AS(Std140Layout::parse_format("v5"), std::invalid_argument);
+    }
+}
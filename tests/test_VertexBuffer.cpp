@@ -0,0 +1,57 @@
+#include <catch2/catch_test_macros.hpp>
+#include "VertexBuffer.hpp"
+
+static std::vector<uint8_t> bytes(std::initializer_list<uint8_t> values)
+{
+    return std::vector<uint8_t>(values);
+}
+
+TEST_CASE("BufferEdits", "[VertexBuffer]")
+{
+    BufferEdits edits;
+    REQUIRE(edits.empty());
+
+    SECTION("disjoint edits stay separate")
+    {
+        edits.add(0, bytes({1, 2}).data(), 2);
+        edits.add(10, bytes({3}).data(), 1);
+        REQUIRE(edits.get_ranges().size() == 2);
+        REQUIRE(edits.get_size() == 3);
+    }
+
+    SECTION("adjacent edits are merged")
+    {
+        edits.add(4, bytes({3, 4}).data(), 2);
+        edits.add(2, bytes({1, 2}).data(), 2);
+        edits.add(6, bytes({5}).data(), 1);
+        REQUIRE(edits.get_ranges().size() == 1);
+        REQUIRE(edits.get_ranges().begin()->first == 2);
+        REQUIRE(edits.get_ranges().begin()->second == bytes({1, 2, 3, 4, 5}));
+    }
+
+    SECTION("overlapping edits keep the latest bytes")
+    {
+        edits.add(0, bytes({1, 1, 1, 1}).data(), 4);
+        edits.add(8, bytes({3, 3}).data(), 2);
+        edits.add(2, bytes({2, 2, 2, 2, 2, 2, 2}).data(), 7);
+        REQUIRE(edits.get_ranges().size() == 1);
+        REQUIRE(edits.get_ranges().begin()->second == bytes({1, 1, 2, 2, 2, 2, 2, 2, 2, 3}));
+    }
+
+    SECTION("an edit inside a range")
+    {
+        edits.add(0, bytes({1, 1, 1, 1}).data(), 4);
+        edits.add(1, bytes({2}).data(), 1);
+        REQUIRE(edits.get_ranges().size() == 1);
+        REQUIRE(edits.get_ranges().begin()->second == bytes({1, 2, 1, 1}));
+    }
+
+    SECTION("clear")
+    {
+        edits.add(0, bytes({1}).data(), 1);
+        edits.add(0, nullptr, 0);
+        edits.clear();
+        REQUIRE(edits.empty());
+        REQUIRE(edits.get_size() == 0);
+    }
+}